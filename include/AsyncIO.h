@@ -0,0 +1,383 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef ASYNC_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// Una lettura di un pezzo di file in un buffer già allocato da chi la chiede
+struct ReadRequest {
+    std::string path;
+    uint64_t offset = 0;
+    size_t size = 0;
+    unsigned char *buffer = nullptr;
+    int priority = 0;   // più alta = prima
+    size_t bytesRead = 0;
+    bool ok = false;    // file aperto e 'size' byte letti (o fino alla fine del file)
+};
+
+// Dimensione del file, -1 se non esiste
+inline long long FileSize(std::string const &path) {
+#ifdef _WIN32
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return -1;
+    _fseeki64(file, 0, SEEK_END);
+    long long size = _ftelli64(file);
+    std::fclose(file);
+    return size;
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) ? (long long)info.st_size : -1;
+#endif
+}
+
+// --- LETTURE A LOTTI ---
+// ReadBatch() legge tutte le richieste e ritorna quando sono finite, partendo
+// dalle priorità più alte. Due backend:
+//   io_uring (Linux, ASYNC_IO_URING): fino a queueDepth letture in volo con una
+//     sola chiamata di sistema per giro; il ring si tiene pieno man mano che
+//     arrivano i completamenti. Usa direttamente le syscall, senza liburing.
+//   pool di thread: i thread del job system prendono le richieste in ordine di
+//     priorità e fanno pread bloccanti (anche dove io_uring non c'è o il kernel
+//     lo rifiuta, es. container con seccomp).
+class AsyncReader {
+public:
+    unsigned int queueDepth = 64;
+    const char *backend = "thread pool";
+
+    AsyncReader() = default;
+    AsyncReader(AsyncReader const &) = delete;
+    AsyncReader &operator=(AsyncReader const &) = delete;
+    ~AsyncReader() { Destroy(); }
+
+    // 'useUring' = false forza il pool di thread (confronti nel benchmark)
+    void Create(bool useUring = true) {
+        Destroy();
+#ifdef ASYNC_IO_URING
+        if (useUring && ring.Create(queueDepth))
+            backend = "io_uring";
+#endif
+        (void)useUring;
+        created = true;
+    }
+
+    void Destroy() {
+#ifdef ASYNC_IO_URING
+        ring.Destroy();
+#endif
+        backend = "thread pool";
+        created = false;
+    }
+
+    // Non rientrante: un lotto alla volta (il ring è uno solo)
+    void ReadBatch(std::vector<ReadRequest> &requests) {
+        CPU_ZONE("AsyncReader::ReadBatch");
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!created)
+            Create();
+        if (requests.empty())
+            return;
+        std::vector<size_t> order(requests.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return requests[a].priority > requests[b].priority; });
+        for (ReadRequest &r : requests) {
+            r.bytesRead = 0;
+            r.ok = false;
+        }
+#ifdef ASYNC_IO_URING
+        if (ring.fd >= 0) {
+            ReadUring(requests, order);
+            return;
+        }
+#endif
+        ReadPool(requests, order);
+    }
+
+private:
+    std::mutex mutex;
+    bool created = false;
+
+    // Un descrittore per file del lotto, aperto una volta anche se ci sono più pezzi
+    struct OpenFiles {
+        std::unordered_map<std::string, int> fds;
+
+        int Get(std::string const &path) {
+            auto it = fds.find(path);
+            if (it != fds.end())
+                return it->second;
+#ifdef _WIN32
+            int fd = -1;
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+#endif
+            fds[path] = fd;
+            return fd;
+        }
+
+        ~OpenFiles() {
+#ifndef _WIN32
+            for (auto const &f : fds)
+                if (f.second >= 0)
+                    close(f.second);
+#endif
+        }
+    };
+
+    void ReadPool(std::vector<ReadRequest> &requests, std::vector<size_t> const &order) {
+        std::atomic<size_t> next{ 0 };
+        // Un job per thread: ognuno prende la prossima richiesta in ordine di priorità
+        jobs.ParallelFor(jobs.ThreadCount(), 1, [&](size_t, size_t) {
+            for (size_t i = next++; i < order.size(); i = next++) {
+                ReadRequest &r = requests[order[i]];
+#ifdef _WIN32
+                FILE *file = std::fopen(r.path.c_str(), "rb");
+                if (!file)
+                    continue;
+                _fseeki64(file, (long long)r.offset, SEEK_SET);
+                r.bytesRead = std::fread(r.buffer, 1, r.size, file);
+                std::fclose(file);
+                r.ok = true;
+#else
+                int fd = open(r.path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    continue;
+                r.ok = true;
+                while (r.bytesRead < r.size) {
+                    ssize_t n = pread(fd, r.buffer + r.bytesRead, r.size - r.bytesRead, (off_t)(r.offset + r.bytesRead));
+                    if (n < 0) {
+                        r.ok = false;
+                        break;
+                    }
+                    if (n == 0)
+                        break; // fine del file
+                    r.bytesRead += (size_t)n;
+                }
+                close(fd);
+#endif
+            }
+        });
+    }
+
+#ifdef ASYNC_IO_URING
+    // Ring di io_uring: code di invio e completamento mappate dal kernel
+    struct Ring {
+        int fd = -1;
+        unsigned int entries = 0, cqEntries = 0;
+        void *sqMap = nullptr, *cqMap = nullptr;
+        size_t sqMapSize = 0, cqMapSize = 0;
+        io_uring_sqe *sqes = nullptr;
+        unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+        unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+
+        bool Create(unsigned int depth) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+            if (fd < 0)
+                return false;
+            entries = params.sq_entries;
+            cqEntries = params.cq_entries;
+            sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single)
+                sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+            sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            cqMap = single ? sqMap
+                           : mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            void *sqeMap = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqMap == MAP_FAILED || cqMap == MAP_FAILED || sqeMap == MAP_FAILED) {
+                if (sqeMap != MAP_FAILED)
+                    munmap(sqeMap, params.sq_entries * sizeof(io_uring_sqe));
+                if (sqMap == MAP_FAILED) sqMap = nullptr;
+                if (cqMap == MAP_FAILED) cqMap = nullptr;
+                Destroy();
+                return false;
+            }
+            sqes = (io_uring_sqe *)sqeMap;
+            char *sq = (char *)sqMap, *cq = (char *)cqMap;
+            sqHead = (unsigned *)(sq + params.sq_off.head);
+            sqTail = (unsigned *)(sq + params.sq_off.tail);
+            sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+            sqArray = (unsigned *)(sq + params.sq_off.array);
+            cqHead = (unsigned *)(cq + params.cq_off.head);
+            cqTail = (unsigned *)(cq + params.cq_off.tail);
+            cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+            cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        void Destroy() {
+            if (sqes)
+                munmap(sqes, entries * sizeof(io_uring_sqe));
+            if (cqMap && cqMap != sqMap)
+                munmap(cqMap, cqMapSize);
+            if (sqMap)
+                munmap(sqMap, sqMapSize);
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+            sqes = nullptr;
+            sqMap = cqMap = nullptr;
+        }
+
+        // Accoda una lettura (da inviare con Enter); falso se la coda è piena.
+        // READV (kernel 5.1) invece di READ (5.6): funziona con ogni io_uring.
+        bool Push(int file, iovec const *buffer, uint64_t offset, uint64_t userData) {
+            unsigned tail = *sqTail;
+            if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= entries)
+                return false;
+            unsigned index = tail & *sqMask;
+            io_uring_sqe &sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = file;
+            sqe.addr = (uint64_t)(uintptr_t)buffer;
+            sqe.len = 1;
+            sqe.off = offset;
+            sqe.user_data = userData;
+            sqArray[index] = index;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        // Voci accodate che il kernel non ha ancora preso (anche dopo un EINTR)
+        unsigned int Unsubmitted() const { return *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE); }
+
+        int Enter(unsigned int submit, unsigned int wait) {
+            return (int)syscall(__NR_io_uring_enter, fd, submit, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        }
+
+        // Completamento successivo, falso se non ce ne sono
+        bool Pop(uint64_t &userData, int &result) {
+            unsigned head = *cqHead;
+            if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+                return false;
+            io_uring_cqe const &cqe = cqes[head & *cqMask];
+            userData = cqe.user_data;
+            result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+    } ring;
+
+    // Attende i completamenti delle letture ancora in volo e li scarta. Con il
+    // limite su maxInFlight nessun completamento va perso, quindi arrivano tutti;
+    // se anche io_uring_enter fallisce si guarda la coda (mappata) ogni millisecondo.
+    void Drain(size_t inFlight) {
+        uint64_t c;
+        int result;
+        while (inFlight) {
+            while (inFlight && ring.Pop(c, result))
+                inFlight--;
+            if (inFlight && ring.Enter(0, 1) < 0)
+                usleep(1000);
+        }
+    }
+
+    void ReadUring(std::vector<ReadRequest> &requests, std::vector<size_t> const &order) {
+        // Le letture lunghe si spezzano in pezzi da 1 MB, in ordine di priorità
+        struct Chunk {
+            size_t request;
+            int fd;
+            iovec buffer;
+            uint64_t offset;
+        };
+        const size_t maxRead = 1u << 20;
+        OpenFiles files;
+        std::vector<Chunk> chunks;
+        for (size_t r : order) {
+            ReadRequest &request = requests[r];
+            int fd = files.Get(request.path);
+            request.ok = fd >= 0;
+            for (size_t done = 0; request.ok && done < request.size; done += maxRead)
+                chunks.push_back({ r, fd, { request.buffer + done, std::min(maxRead, request.size - done) }, request.offset + done });
+        }
+
+        // Mai più letture in volo dei posti nella coda dei completamenti: i kernel
+        // senza IORING_FEAT_NODROP (prima del 5.5) scarterebbero quelli in eccesso
+        const size_t maxInFlight = std::min(ring.entries, ring.cqEntries);
+        size_t next = 0, inFlight = 0;
+        while (next < chunks.size() || inFlight) {
+            // Ring sempre pieno: una syscall invia i nuovi pezzi e attende almeno un completamento
+            unsigned int pushed = 0;
+            for (; next < chunks.size() && inFlight + pushed < maxInFlight; next++, pushed++) {
+                Chunk &chunk = chunks[next];
+                if (!ring.Push(chunk.fd, &chunk.buffer, chunk.offset, next))
+                    break;
+            }
+            inFlight += pushed;
+            if (ring.Enter(ring.Unsubmitted(), 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // Ring inutilizzabile: si chiude e il lotto si rilegge col pool di thread.
+                // Prima si aspettano le letture già inviate, che altrimenti il kernel
+                // potrebbe completare nei buffer mentre li riempie pread.
+                std::cout << "ERRORE::IO_URING:: io_uring_enter " << std::strerror(errno) << std::endl;
+                inFlight -= ring.Unsubmitted(); // mai arrivate al kernel
+                Drain(inFlight);
+                ring.Destroy();
+                backend = "thread pool";
+                for (ReadRequest &r : requests) {
+                    r.bytesRead = 0;
+                    r.ok = false;
+                }
+                ReadPool(requests, order);
+                return;
+            }
+            uint64_t c;
+            int result;
+            while (ring.Pop(c, result)) {
+                inFlight--;
+                Chunk const &chunk = chunks[c];
+                ReadRequest &request = requests[chunk.request];
+                if (result < 0) {
+                    request.ok = false;
+                    continue;
+                }
+                // Lettura corta prima della fine del file (rara su file regolari): si completa bloccante
+                size_t got = (size_t)result;
+                while (result > 0 && got < chunk.buffer.iov_len) {
+                    ssize_t n = pread(chunk.fd, (char *)chunk.buffer.iov_base + got, chunk.buffer.iov_len - got, (off_t)(chunk.offset + got));
+                    if (n <= 0)
+                        break;
+                    got += (size_t)n;
+                }
+                request.bytesRead += got;
+            }
+        }
+    }
+#endif
+};
+
+// Istanza globale per il caricamento degli asset (creata al primo lotto)
+inline AsyncReader assetReader;
+
+#endif
@@ -0,0 +1,489 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "AsyncIO.h"
+#include "ClusteredLighting.h"
+#include "EntityRegistry.h"
+#include "JobSystem.h"
+#include "Model.h" // Vertex e stb_image
+#include "Scatter.h"
+#include "Scene.h"
+#include "Terrain.h"
+#include "TransformKernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+// --- MICROBENCHMARK DA RIGA DI COMANDO ---
+// Girano solo sulla CPU, prima di creare la finestra (es. ./Computer_Graphics --bench-lights)
+
+inline double ElapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Costruzione delle liste del clustered lighting da 64 a 8192 luci,
+// con un thread e con tutti i core. "luci/cluster" è il lavoro per fragment
+// dello shading clusterizzato, contro N luci del loop ingenuo.
+inline void BenchmarkClusteredLighting() {
+    const int iterations = 50;
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 3.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::printf("%8s %12s %12s %14s\n", "luci", "1 thread ms", "N thread ms", "luci/cluster");
+    for (unsigned int count : { 64u, 256u, 1024u, 2048u, 4096u, 8192u }) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> x(-100.0f, 100.0f), y(-2.0f, 15.0f), z(-200.0f, 0.0f), r(2.0f, 8.0f);
+        std::vector<PointLight> lights(count);
+        for (PointLight &light : lights)
+            light = { glm::vec3(x(rng), y(rng), z(rng)), r(rng), glm::vec3(1.0f, 0.8f, 0.4f), 1.0f };
+
+        ClusteredLighting clusters;
+        clusters.SetProjection(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+
+        double timings[2];
+        for (int parallel = 0; parallel < 2; parallel++) {
+            clusters.parallelThreshold = parallel ? 0 : 0xFFFFFFFFu;
+            clusters.Build(lights, view); // riscaldamento
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+                clusters.Build(lights, view);
+            timings[parallel] = ElapsedMs(start) / iterations;
+        }
+        std::printf("%8u %12.3f %12.3f %14.2f\n", count, timings[0], timings[1],
+                    (double)clusters.totalIndices / clusters.ClusterCount());
+    }
+}
+
+// Scalabilità del job system da 1 thread a tutti i core sui carichi che lo usano:
+// decodifica delle texture di assets/, conversione dei vertici come in
+// Model::processMesh, trasformazioni, bounds e LOD delle entità, culling sul
+// frustum e liste del clustered lighting. Ogni riga è il tempo medio e lo
+// speedup su 1 thread; in fondo il costo di creare e distruggere le entità.
+inline void BenchmarkJobSystem(std::string const &assetsDirectory) {
+    const size_t objectCount = 200000, vertexCount = 2000000;
+
+    // Le immagini si leggono da disco una volta: si misura solo la decodifica
+    std::vector<std::vector<unsigned char>> files;
+    std::error_code ec;
+    for (auto const &entry : std::filesystem::recursive_directory_iterator(assetsDirectory, ec)) {
+        std::string extension = entry.path().extension().string();
+        if (files.size() < 16 && (extension == ".png" || extension == ".jpg")) {
+            std::FILE *file = std::fopen(entry.path().string().c_str(), "rb");
+            if (!file) continue;
+            std::vector<unsigned char> bytes;
+            unsigned char buffer[65536];
+            size_t n;
+            while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                bytes.insert(bytes.end(), buffer, buffer + n);
+            std::fclose(file);
+            files.push_back(std::move(bytes));
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f), angle(0.0f, 6.2831853f);
+    std::vector<glm::vec3> positions(objectCount);
+    std::vector<float> angles(objectCount);
+    for (size_t i = 0; i < objectCount; i++) {
+        positions[i] = glm::vec3(position(rng), 0.0f, position(rng));
+        angles[i] = angle(rng);
+    }
+    std::vector<unsigned char> visible(objectCount);
+    AABB localBox;
+    localBox.Expand(glm::vec3(-1.0f, 0.0f, -1.0f));
+    localBox.Expand(glm::vec3(1.0f, 6.0f, 1.0f));
+
+    EntityRegistry scene;
+    scene.Reserve(objectCount);
+    auto createStart = std::chrono::high_resolution_clock::now();
+    std::vector<Entity> entities(objectCount);
+    for (size_t i = 0; i < objectCount; i++)
+        entities[i] = scene.Create(nullptr, glm::translate(glm::mat4(1.0f), positions[i]), localBox);
+    double createMs = ElapsedMs(createStart);
+    Frustum frustum(glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+                    glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 3.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    std::vector<float> rawVertices(vertexCount * 8);
+    for (float &v : rawVertices)
+        v = position(rng);
+    std::vector<Vertex> vertices(vertexCount);
+
+    std::vector<PointLight> lights(4096);
+    std::uniform_real_distribution<float> x(-100.0f, 100.0f), y(-2.0f, 15.0f), z(-200.0f, 0.0f), r(2.0f, 8.0f);
+    for (PointLight &light : lights)
+        light = { glm::vec3(x(rng), y(rng), z(rng)), r(rng), glm::vec3(1.0f, 0.8f, 0.4f), 1.0f };
+    ClusteredLighting clusters;
+    clusters.SetProjection(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 3.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    struct Workload {
+        const char *name;
+        std::function<void()> run;
+    };
+    std::vector<Workload> workloads = {
+        { "decodifica texture", [&]() {
+            jobs.ParallelFor(files.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    int w, h, n;
+                    stbi_image_free(stbi_load_from_memory(files[i].data(), (int)files[i].size(), &w, &h, &n, 4));
+                }
+            });
+        } },
+        { "conversione mesh", [&]() {
+            jobs.ParallelFor(vertexCount, 65536, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    float const *v = &rawVertices[i * 8];
+                    vertices[i].Position = glm::vec3(v[0], v[1], v[2]);
+                    vertices[i].Normal = glm::vec3(v[3], v[4], v[5]);
+                    vertices[i].TexCoords = glm::vec2(v[6], v[7]);
+                    vertices[i].Tangent = glm::vec3(0.0f);
+                }
+            });
+        } },
+        { "trasformazioni", [&]() {
+            std::vector<glm::mat4> &transforms = scene.Transforms();
+            jobs.ParallelFor(objectCount, 4096, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    transforms[i] = glm::rotate(glm::translate(glm::mat4(1.0f), positions[i]), angles[i], glm::vec3(0.0f, 1.0f, 0.0f));
+            });
+        } },
+        { "bounds + LOD", [&]() { scene.UpdateBounds(); scene.UpdateLod(glm::vec3(0.0f, 3.0f, 0.0f)); } },
+        { "culling frustum", [&]() {
+            std::vector<AABB> const &bounds = scene.Components().bounds;
+            jobs.ParallelFor(objectCount, 4096, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    visible[i] = frustum.Intersects(bounds[i]);
+            });
+        } },
+        { "cluster 4096 luci", [&]() { clusters.parallelThreshold = 0; clusters.Build(lights, view); } },
+    };
+
+    std::vector<unsigned int> threadCounts;
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int t = 1; t < cores; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(cores);
+
+    std::printf("%-20s", "carico");
+    for (unsigned int t : threadCounts)
+        std::printf(" %9u thr", t);
+    std::printf("\n");
+    for (Workload const &workload : workloads) {
+        std::printf("%-20s", workload.name);
+        double baseline = 0.0;
+        for (unsigned int t : threadCounts) {
+            jobs.Start(t);
+            workload.run(); // riscaldamento
+            const int iterations = 5;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+                workload.run();
+            double ms = ElapsedMs(start) / iterations;
+            if (t == 1)
+                baseline = ms;
+            std::printf(" %7.2fms x%.1f", ms, baseline / ms);
+        }
+        std::printf("\n");
+    }
+    // Distruzione in ordine casuale (ogni riga tolta viene riempita dall'ultima)
+    std::shuffle(entities.begin(), entities.end(), rng);
+    auto destroyStart = std::chrono::high_resolution_clock::now();
+    for (Entity const &entity : entities)
+        scene.Destroy(entity);
+    double destroyMs = ElapsedMs(destroyStart);
+    std::printf("entità: %zu create in %.2f ms, distrutte in %.2f ms\n", objectCount, createMs, destroyMs);
+    std::printf("(%zu immagini, %zu vertici, %zu oggetti)\n", files.size(), vertexCount, objectCount);
+    jobs.Start();
+}
+
+// Kernel delle trasformazioni contro glm scalare su un bosco di oggetti: matrici
+// mondo da TRS, box e sfere in coordinate mondo. Single thread, per misurare il
+// kernel e non lo scheduling; l'errore è la massima differenza dal percorso glm.
+inline void BenchmarkTransforms() {
+    const size_t count = 262144;
+    const int iterations = 10;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f), angle(0.0f, 6.2831853f), scale(0.7f, 1.4f);
+    TransformSoA trs;
+    trs.Reserve(count);
+    std::vector<AABB> local(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::quat rotation = glm::angleAxis(angle(rng), glm::normalize(glm::vec3(0.1f, 1.0f, 0.05f)));
+        trs.Push(glm::vec3(position(rng), 0.0f, position(rng)), rotation, glm::vec3(scale(rng)));
+        local[i].Expand(glm::vec3(-1.0f, 0.0f, -1.0f));
+        local[i].Expand(glm::vec3(1.0f, 6.0f + (float)(i % 7), 1.0f));
+    }
+    std::vector<glm::mat4> reference(count), matrices(count);
+    std::vector<AABB> referenceBounds(count), bounds(count);
+    std::vector<glm::vec4> referenceSpheres(count), spheres(count);
+
+    auto measure = [&](std::function<void()> const &run) {
+        run(); // riscaldamento
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+            run();
+        return ElapsedMs(start) / iterations;
+    };
+
+    double glmCompose = measure([&]() {
+        for (size_t i = 0; i < count; i++) {
+            glm::quat rotation(trs.qw[i], trs.qx[i], trs.qy[i], trs.qz[i]);
+            reference[i] = glm::translate(glm::mat4(1.0f), glm::vec3(trs.px[i], trs.py[i], trs.pz[i])) *
+                           glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), glm::vec3(trs.sx[i], trs.sy[i], trs.sz[i]));
+        }
+    });
+    double scalarCompose = measure([&]() { ComposeTransformsScalar(trs, 0, count, matrices.data()); });
+    double kernelCompose = measure([&]() { ComposeTransforms(trs, 0, count, matrices.data()); });
+
+    double glmBounds = measure([&]() {
+        for (size_t i = 0; i < count; i++) {
+            referenceBounds[i] = local[i].Transform(reference[i]);
+            referenceSpheres[i] = glm::vec4(referenceBounds[i].Center(), glm::length(referenceBounds[i].Extents()));
+        }
+    });
+    double kernelBounds = measure([&]() { TransformBounds(matrices.data(), local.data(), 0, count, bounds.data(), spheres.data()); });
+
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                error = std::max(error, std::fabs(matrices[i][c][r] - reference[i][c][r]));
+        error = std::max(error, glm::length(bounds[i].Min - referenceBounds[i].Min));
+        error = std::max(error, glm::length(bounds[i].Max - referenceBounds[i].Max));
+        error = std::max(error, std::fabs(spheres[i].w - referenceSpheres[i].w));
+    }
+
+    std::printf("%zu oggetti, kernel %s\n", count, TransformKernelName());
+    std::printf("%-26s %10s %10s\n", "", "ms", "Mogg/s");
+    std::printf("%-26s %10.3f %10.1f\n", "TRS glm (T * R * S)", glmCompose, count / glmCompose / 1000.0);
+    std::printf("%-26s %10.3f %10.1f\n", "TRS scalare a colonne", scalarCompose, count / scalarCompose / 1000.0);
+    std::printf("%-26s %10.3f %10.1f  x%.1f\n", "TRS kernel", kernelCompose, count / kernelCompose / 1000.0, glmCompose / kernelCompose);
+    std::printf("%-26s %10.3f %10.1f\n", "box + sfera glm", glmBounds, count / glmBounds / 1000.0);
+    std::printf("%-26s %10.3f %10.1f  x%.1f\n", "box + sfera kernel", kernelBounds, count / kernelBounds / 1000.0, glmBounds / kernelBounds);
+    std::printf("errore massimo rispetto a glm: %g\n", error);
+}
+
+// Scatter di circa un milione di istanze sul terreno procedurale da 4 km, con
+// 1 thread e con tutti i core. L'impronta delle matrici deve essere uguale in
+// ogni colonna: il risultato non dipende dal numero di thread.
+inline void BenchmarkScatter() {
+    Terrain terrain;
+    terrain.LoadHeights("", 7);
+    ScatterLayer layer;
+    layer.name = "bench";
+    layer.minDistance = 3.7f;
+    layer.maxSlope = 40.0f;
+    layer.density = [](float x, float z) { return x * x + z * z > 400.0f ? 1.0f : 0.0f; };
+    std::vector<ScatterLayer> layers = { layer };
+
+    std::vector<unsigned int> threadCounts;
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int t = 1; t < cores; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(cores);
+
+    std::printf("%8s %10s %10s %10s %18s\n", "thread", "istanze", "ms", "Mist/s", "impronta");
+    for (unsigned int t : threadCounts) {
+        jobs.Start(t);
+        Scatter scatter;
+        scatter.Generate(terrain, layers, 1); // riscaldamento
+        const int iterations = 3;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+            scatter.Generate(terrain, layers, 1);
+        double ms = ElapsedMs(start) / iterations;
+
+        // FNV-1a sui byte delle matrici
+        uint64_t hash = 1469598103934665603ull;
+        std::vector<glm::mat4> const &matrices = scatter.sets[0].matrices;
+        unsigned char const *bytes = (unsigned char const *)matrices.data();
+        for (size_t i = 0; i < matrices.size() * sizeof(glm::mat4); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        std::printf("%8u %10zu %10.1f %10.2f %18llx\n", t, scatter.InstanceCount(), ms,
+                    scatter.InstanceCount() / ms / 1000.0, (unsigned long long)hash);
+    }
+    jobs.Start();
+}
+
+// Letture di file: fopen/fread bloccante file per file (come stb_image e Assimp
+// prima dei lotti) contro AsyncReader con il pool di thread e con io_uring.
+// I file sono gli asset più 256 pezzi sintetici da 256 KB, come le celle del
+// mondo; "freddo" toglie prima i file dalla cache delle pagine (posix_fadvise),
+// quindi misura il disco e non memcpy dal kernel.
+inline void BenchmarkAsyncIO(std::string const &assetsDirectory) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (auto const &entry : std::filesystem::recursive_directory_iterator(assetsDirectory, ec))
+        if (entry.is_regular_file(ec))
+            paths.push_back(entry.path().string());
+    std::filesystem::path chunkDirectory = std::filesystem::temp_directory_path(ec) / "bench_io";
+    std::filesystem::create_directories(chunkDirectory, ec);
+    std::mt19937 rng(42);
+    std::vector<unsigned char> chunk(256 * 1024);
+    for (int i = 0; i < 256; i++) {
+        std::string path = (chunkDirectory / ("chunk_" + std::to_string(i) + ".bin")).string();
+        if (FileSize(path) != (long long)chunk.size()) {
+            for (unsigned char &b : chunk)
+                b = (unsigned char)rng();
+            if (std::FILE *file = std::fopen(path.c_str(), "wb")) {
+                std::fwrite(chunk.data(), 1, chunk.size(), file);
+                std::fclose(file);
+            }
+        }
+        paths.push_back(path);
+    }
+
+    std::vector<std::vector<unsigned char>> buffers;
+    size_t totalBytes = 0;
+    for (std::string const &path : paths) {
+        buffers.emplace_back((size_t)std::max(0LL, FileSize(path)));
+        totalBytes += buffers.back().size();
+    }
+    auto evict = [&]() {
+#ifndef _WIN32
+        for (std::string const &path : paths) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                continue;
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+#endif
+    };
+
+    struct Mode {
+        const char *name;
+        std::function<size_t()> run; // byte letti
+    };
+    AsyncReader pool, uring;
+    pool.Create(false);
+    uring.Create(true);
+    auto batch = [&](AsyncReader &reader) {
+        std::vector<ReadRequest> requests(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            requests[i].path = paths[i];
+            requests[i].size = buffers[i].size();
+            requests[i].buffer = buffers[i].data();
+        }
+        reader.ReadBatch(requests);
+        size_t bytes = 0;
+        for (ReadRequest const &r : requests)
+            bytes += r.bytesRead;
+        return bytes;
+    };
+    std::vector<Mode> modes = {
+        { "fopen/fread", [&]() {
+            size_t bytes = 0;
+            for (size_t i = 0; i < paths.size(); i++)
+                if (std::FILE *file = std::fopen(paths[i].c_str(), "rb")) {
+                    bytes += std::fread(buffers[i].data(), 1, buffers[i].size(), file);
+                    std::fclose(file);
+                }
+            return bytes;
+        } },
+        { "pool di thread", [&]() { return batch(pool); } },
+    };
+    if (std::strcmp(uring.backend, "io_uring") == 0)
+        modes.push_back({ "io_uring", [&]() { return batch(uring); } });
+    else
+        std::printf("io_uring non disponibile: solo pool di thread\n");
+
+    std::printf("%zu file, %.1f MB, %u thread, coda io_uring %u\n", paths.size(), totalBytes / 1048576.0,
+                jobs.ThreadCount(), uring.queueDepth);
+    std::printf("%-16s %12s %10s %12s %10s\n", "lettura", "freddo ms", "MB/s", "caldo ms", "MB/s");
+    for (Mode const &mode : modes) {
+        const int iterations = 3;
+        double cold = 0.0, warm = 0.0;
+        size_t bytes = 0;
+        for (int i = 0; i < iterations; i++) {
+            evict();
+            auto start = std::chrono::high_resolution_clock::now();
+            bytes = mode.run();
+            cold += ElapsedMs(start) / iterations;
+        }
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            mode.run();
+            warm += ElapsedMs(start) / iterations;
+        }
+        if (bytes != totalBytes)
+            std::cout << "ERRORE::BENCH_IO:: " << mode.name << " ha letto " << bytes << " byte su " << totalBytes << std::endl;
+        std::printf("%-16s %12.2f %10.1f %12.2f %10.1f\n", mode.name, cold, bytes / 1048576.0 / (cold / 1000.0), warm,
+                    bytes / 1048576.0 / (warm / 1000.0));
+    }
+}
+
+// --- BENCHMARK DEL PERCORSO DI VOLO ---
+
+struct Percentiles {
+    double avg = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+// Percentili "nearest rank" (il campione p-esimo per ordine, senza interpolare)
+inline Percentiles ComputePercentiles(std::vector<double> samples) {
+    Percentiles out;
+    if (samples.empty())
+        return out;
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&](double p) {
+        size_t index = (size_t)std::ceil(p * samples.size());
+        return samples[std::min(std::max(index, (size_t)1), samples.size()) - 1];
+    };
+    for (double s : samples)
+        out.avg += s;
+    out.avg /= samples.size();
+    out.p50 = rank(0.50);
+    out.p95 = rank(0.95);
+    out.p99 = rank(0.99);
+    out.max = samples.back();
+    return out;
+}
+
+// Campioni per frame raccolti durante il volo, più ciò che serve per
+// confrontare due esecuzioni (stessa risoluzione, seed, backend)
+struct FlythroughResult {
+    std::string renderer, backend, gpu;
+    int width = 0, height = 0;
+    unsigned int seed = 0;
+    std::vector<double> cpuMs, gpuMs, drawCalls, triangles;
+};
+
+inline void WritePercentilesJson(FILE *file, const char *name, std::vector<double> const &samples, bool last) {
+    Percentiles p = ComputePercentiles(samples);
+    std::fprintf(file, "  \"%s\": { \"samples\": %zu, \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+                 name, samples.size(), p.avg, p.p50, p.p95, p.p99, p.max, last ? "" : ",");
+}
+
+inline bool WriteFlythroughJson(std::string const &path, FlythroughResult const &result) {
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::printf("ERRORE::BENCHMARK:: impossibile scrivere %s\n", path.c_str());
+        return false;
+    }
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"renderer\": \"%s\",\n  \"backend\": \"%s\",\n  \"gpu\": \"%s\",\n",
+                 result.renderer.c_str(), result.backend.c_str(), result.gpu.c_str());
+    std::fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"seed\": %u,\n  \"frames\": %zu,\n",
+                 result.width, result.height, result.seed, result.cpuMs.size());
+    WritePercentilesJson(file, "cpu_ms", result.cpuMs, false);
+    WritePercentilesJson(file, "gpu_ms", result.gpuMs, false);
+    WritePercentilesJson(file, "draw_calls", result.drawCalls, false);
+    WritePercentilesJson(file, "triangles", result.triangles, true);
+    std::fprintf(file, "}\n");
+    std::fclose(file);
+    return true;
+}
+
+#endif
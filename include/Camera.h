@@ -86,6 +86,14 @@ public:
         updateCameraVectors();
     }
 
+    // Posa impostata dall'esterno (percorsi scriptati dei benchmark)
+    void SetPose(glm::vec3 const &position, float yaw, float pitch) {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
     // Gestisce lo zoom (rotella mouse)
     void ProcessMouseScroll(float yoffset) {
         Zoom -= (float)yoffset;
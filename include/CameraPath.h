@@ -0,0 +1,99 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Una posa della camera lungo il percorso
+struct CameraKey {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// --- PERCORSO DI VOLO DELLA CAMERA ---
+// Spline Catmull-Rom per i punti chiave (posizione e angoli), percorsa con un
+// parametro in [0, 1]: il benchmark la campiona a passo fisso invece di leggere
+// tastiera e mouse, così ogni esecuzione vede esattamente le stesse inquadrature.
+// I punti si registrano in finestra (F3) in un file di testo "x y z yaw pitch".
+class CameraPath {
+public:
+    std::vector<CameraKey> keys;
+
+    // Giro predefinito della radura: entra dal fondo, gira attorno all'albero e alla roccia
+    static CameraPath Default() {
+        CameraPath path;
+        path.keys = {
+            { glm::vec3(  0.0f, 3.0f,  15.0f), -90.0f,  -5.0f },
+            { glm::vec3(  8.0f, 2.0f,   6.0f), -120.0f, -8.0f },
+            { glm::vec3(  9.0f, 1.0f,  -6.0f), -170.0f, -5.0f },
+            { glm::vec3(  0.0f, 4.0f, -16.0f), -270.0f, -12.0f },
+            { glm::vec3( -9.0f, 1.5f,  -6.0f), -330.0f, -5.0f },
+            { glm::vec3( -6.0f, 6.0f,   8.0f), -420.0f, -20.0f },
+            { glm::vec3(  0.0f, 3.0f,  15.0f), -450.0f, -5.0f },
+        };
+        return path;
+    }
+
+    bool Load(std::string const &file) {
+        std::ifstream in(file);
+        if (!in) {
+            std::cout << "ERRORE::CAMERA_PATH:: file non trovato: " << file << std::endl;
+            return false;
+        }
+        keys.clear();
+        CameraKey key;
+        while (in >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch)
+            keys.push_back(key);
+        return keys.size() >= 2;
+    }
+
+    static void Append(std::string const &file, Camera const &camera) {
+        std::ofstream out(file, std::ios::app);
+        out << camera.Position.x << " " << camera.Position.y << " " << camera.Position.z << " "
+            << camera.Yaw << " " << camera.Pitch << "\n";
+    }
+
+    // t in [0, 1]: segmenti di uguale durata tra punti chiave consecutivi
+    CameraKey Sample(float t) const {
+        if (keys.size() < 2)
+            return keys.empty() ? CameraKey{ glm::vec3(0.0f, 3.0f, 15.0f), YAW, PITCH } : keys[0];
+        float s = glm::clamp(t, 0.0f, 1.0f) * (float)(keys.size() - 1);
+        int i = std::min((int)s, (int)keys.size() - 2);
+        float u = s - (float)i;
+
+        // Agli estremi si ripete il punto: tangente nulla invece di extrapolare
+        CameraKey const &p0 = keys[std::max(i - 1, 0)];
+        CameraKey const &p1 = keys[i];
+        CameraKey const &p2 = keys[i + 1];
+        CameraKey const &p3 = keys[std::min(i + 2, (int)keys.size() - 1)];
+
+        CameraKey out;
+        out.position = CatmullRom(p0.position, p1.position, p2.position, p3.position, u);
+        out.yaw = CatmullRom(p0.yaw, p1.yaw, p2.yaw, p3.yaw, u);
+        out.pitch = glm::clamp(CatmullRom(p0.pitch, p1.pitch, p2.pitch, p3.pitch, u), -89.0f, 89.0f);
+        return out;
+    }
+
+    void Apply(Camera &camera, float t) const {
+        CameraKey key = Sample(t);
+        camera.SetPose(key.position, key.yaw, key.pitch);
+    }
+
+private:
+    template <typename T>
+    static T CatmullRom(T const &p0, T const &p1, T const &p2, T const &p3, float u) {
+        float u2 = u * u, u3 = u2 * u;
+        return ((p1 * 2.0f) + (p2 - p0) * u + (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * u2
+                + (p1 * 3.0f - p0 - p2 * 3.0f + p3) * u3) * 0.5f;
+    }
+};
+
+#endif
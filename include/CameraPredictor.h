@@ -0,0 +1,93 @@
+#ifndef CAMERA_PREDICTOR_H
+#define CAMERA_PREDICTOR_H
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+#include <cmath>
+#include <deque>
+
+// --- PREDIZIONE DEL MOTO DELLA CAMERA ---
+// Tiene le pose degli ultimi 'window' secondi e ne stima velocità lineare e
+// velocità di rotazione (yaw, pitch) con una retta ai minimi quadrati: un
+// campione storto o un frame lungo pesano poco. L'estrapolazione è lineare
+// e limitata a 'maxSpeed', quindi un salto della camera (teletrasporto del
+// percorso scriptato) non manda la predizione a chilometri di distanza.
+class CameraPredictor {
+public:
+    float window = 0.5f;      // secondi di storia usati per la stima
+    float maxSpeed = 100.0f;  // m/s
+
+    // Da chiamare una volta per istantanea, con il tempo della simulazione
+    void Record(float time, Camera const &camera) {
+        if (!samples.empty() && time < samples.back().time)
+            samples.clear(); // tempo tornato indietro: storia non più valida
+        Sample sample = { time, camera.Position, camera.Yaw, camera.Pitch };
+        // Stesso istante (più istantanee nello stesso passo): vale l'ultima posizione
+        if (!samples.empty() && time == samples.back().time)
+            samples.back() = sample;
+        else
+            samples.push_back(sample);
+        while (samples.size() > 2 && samples.back().time - samples.front().time > window)
+            samples.pop_front();
+        Fit();
+    }
+
+    glm::vec3 Position() const { return samples.empty() ? glm::vec3(0.0f) : samples.back().position; }
+    glm::vec3 Velocity() const { return velocity; }
+
+    glm::vec3 PredictPosition(float seconds) const { return Position() + velocity * seconds; }
+
+    // Direzione di vista fra 'seconds' secondi (stessa formula di Camera)
+    glm::vec3 PredictFront(float seconds) const {
+        if (samples.empty())
+            return glm::vec3(0.0f, 0.0f, -1.0f);
+        float yaw = glm::radians(samples.back().yaw + yawRate * seconds);
+        float pitch = glm::radians(glm::clamp(samples.back().pitch + pitchRate * seconds, -89.0f, 89.0f));
+        return glm::normalize(glm::vec3(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch)));
+    }
+
+private:
+    struct Sample {
+        float time;
+        glm::vec3 position;
+        float yaw, pitch;
+    };
+
+    std::deque<Sample> samples;
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float yawRate = 0.0f, pitchRate = 0.0f; // gradi al secondo
+
+    // Pendenza della retta ai minimi quadrati di ogni componente rispetto al tempo
+    void Fit() {
+        velocity = glm::vec3(0.0f);
+        yawRate = pitchRate = 0.0f;
+        if (samples.size() < 2)
+            return;
+        float meanTime = 0.0f;
+        for (Sample const &s : samples)
+            meanTime += s.time;
+        meanTime /= (float)samples.size();
+        float denominator = 0.0f;
+        glm::vec3 position(0.0f);
+        float yaw = 0.0f, pitch = 0.0f;
+        for (Sample const &s : samples) {
+            float t = s.time - meanTime;
+            denominator += t * t;
+            position += t * (s.position - samples.back().position);
+            yaw += t * (s.yaw - samples.back().yaw);
+            pitch += t * (s.pitch - samples.back().pitch);
+        }
+        if (denominator <= 0.0f)
+            return;
+        velocity = position / denominator;
+        float speed = glm::length(velocity);
+        if (speed > maxSpeed)
+            velocity *= maxSpeed / speed;
+        yawRate = yaw / denominator;
+        pitchRate = pitch / denominator;
+    }
+};
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "RenderStats.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Luce puntiforme locale (fuochi, lanterne, lucciole)
+struct PointLight {
+    glm::vec3 Position;
+    float     Radius;    // oltre questo raggio il contributo è zero
+    glm::vec3 Color;
+    float     Intensity;
+};
+
+// Unità texture riservate ai buffer del clustered lighting (vedi lighting.glsl)
+const unsigned int LIGHT_DATA_UNIT    = 8;
+const unsigned int CLUSTER_DATA_UNIT  = 9;
+const unsigned int LIGHT_INDEX_UNIT   = 10;
+const unsigned int LIGHTING_UBO_BINDING = 1;
+
+// --- CLUSTERED FORWARD LIGHTING ---
+// Il frustum di vista è diviso in una griglia di "froxel": tilesX x tilesY in
+// schermo e slicesZ fette in profondità (distribuite in modo esponenziale).
+// Per ogni cluster si costruisce sulla CPU la lista delle luci che lo toccano
+// e si carica in tre texture buffer; il fragment shader trova il suo cluster
+// da gl_FragCoord e dalla profondità e scorre solo quelle luci.
+class ClusteredLighting {
+public:
+    unsigned int tilesX, tilesY, slicesZ;
+
+    // Statistiche dell'ultimo Build (per i benchmark)
+    unsigned int visibleLights = 0;
+    unsigned int totalIndices  = 0;
+
+    // Oltre questa soglia di luci la costruzione si divide tra più thread
+    unsigned int parallelThreshold = 256;
+
+    ClusteredLighting(unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int slicesZ = 24)
+        : tilesX(tilesX), tilesY(tilesY), slicesZ(slicesZ) {}
+
+    unsigned int ClusterCount() const { return tilesX * tilesY * slicesZ; }
+
+    // Cambia la griglia (es. tile da 16 pixel del deferred quando cambia la risoluzione)
+    void Resize(unsigned int tilesX, unsigned int tilesY, unsigned int slicesZ) {
+        this->tilesX = tilesX;
+        this->tilesY = tilesY;
+        this->slicesZ = slicesZ;
+        fovY = 0.0f; // forza il ricalcolo dei box in SetProjection
+    }
+
+    // Da chiamare quando cambiano fov, aspect o piani di clipping
+    void SetProjection(float fovY, float aspect, float zNear, float zFar) {
+        if (fovY == this->fovY && aspect == this->aspect && zNear == this->zNear && zFar == this->zFar)
+            return;
+        this->fovY = fovY; this->aspect = aspect; this->zNear = zNear; this->zFar = zFar;
+        tanY = std::tan(fovY * 0.5f);
+        tanX = tanY * aspect;
+        logScale = slicesZ / std::log(zFar / zNear);
+        logBias  = slicesZ * std::log(zNear) / std::log(zFar / zNear);
+
+        // AABB in view space di ogni cluster (z positiva verso l'osservatore -> usiamo la profondità)
+        clusterMin.resize(ClusterCount());
+        clusterMax.resize(ClusterCount());
+        for (unsigned int z = 0; z < slicesZ; z++) {
+            float dNear = SliceDepth(z), dFar = SliceDepth(z + 1);
+            for (unsigned int y = 0; y < tilesY; y++) {
+                for (unsigned int x = 0; x < tilesX; x++) {
+                    float nx0 = -1.0f + 2.0f * x / tilesX, nx1 = -1.0f + 2.0f * (x + 1) / tilesX;
+                    float ny0 = -1.0f + 2.0f * y / tilesY, ny1 = -1.0f + 2.0f * (y + 1) / tilesY;
+                    glm::vec3 lo(1e30f), hi(-1e30f);
+                    for (float d : { dNear, dFar }) {
+                        for (float nx : { nx0, nx1 }) {
+                            for (float ny : { ny0, ny1 }) {
+                                glm::vec3 p(nx * d * tanX, ny * d * tanY, -d);
+                                lo = glm::min(lo, p);
+                                hi = glm::max(hi, p);
+                            }
+                        }
+                    }
+                    unsigned int c = Index(x, y, z);
+                    clusterMin[c] = lo;
+                    clusterMax[c] = hi;
+                }
+            }
+        }
+    }
+
+    // Costruisce le liste di luci per cluster (solo CPU, niente chiamate GL)
+    void Build(std::vector<PointLight> const &lights, glm::mat4 const &view) {
+        CPU_ZONE("ClusteredLighting::Build");
+        // 1. Luci in view space e intervallo di cluster che possono toccare
+        viewLights.resize(lights.size());
+        ranges.resize(lights.size());
+        visibleLights = 0;
+        for (size_t i = 0; i < lights.size(); i++) {
+            glm::vec4 p = view * glm::vec4(lights[i].Position, 1.0f);
+            viewLights[i] = glm::vec4(p.x, p.y, p.z, lights[i].Radius);
+            ranges[i] = LightRange(viewLights[i]);
+            if (ranges[i].z0 <= ranges[i].z1)
+                visibleLights++;
+        }
+
+        // 2. Ogni fetta in profondità è indipendente: una fetta per job
+        sliceLists.resize(slicesZ);
+        if (lights.size() >= parallelThreshold) {
+            jobs.ParallelFor(slicesZ, 1, [this](size_t begin, size_t end) {
+                for (size_t z = begin; z < end; z++)
+                    BuildSlice((unsigned int)z);
+            });
+        } else {
+            for (unsigned int z = 0; z < slicesZ; z++)
+                BuildSlice(z);
+        }
+
+        // 3. Concatena le liste: (offset, conteggio) per cluster + indici contigui
+        clusterData.resize(ClusterCount() * 2);
+        indices.clear();
+        for (unsigned int z = 0; z < slicesZ; z++) {
+            SliceList &slice = sliceLists[z];
+            for (unsigned int t = 0; t < tilesX * tilesY; t++) {
+                unsigned int c = z * tilesX * tilesY + t;
+                clusterData[c * 2 + 0] = (unsigned int)indices.size();
+                clusterData[c * 2 + 1] = slice.counts[t];
+                indices.insert(indices.end(), slice.indices.begin() + slice.offsets[t],
+                               slice.indices.begin() + slice.offsets[t] + slice.counts[t]);
+            }
+        }
+        totalIndices = (unsigned int)indices.size();
+
+        // Dati luce compatti: due texel RGBA32F per luce
+        lightData.resize(lights.size() * 2);
+        for (size_t i = 0; i < lights.size(); i++) {
+            lightData[i * 2 + 0] = glm::vec4(lights[i].Position, lights[i].Radius);
+            lightData[i * 2 + 1] = glm::vec4(lights[i].Color * lights[i].Intensity, 0.0f);
+        }
+    }
+
+    // --- PARTE GPU ---
+    void Create() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingBlock), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTING_UBO_BINDING, UBO);
+    }
+
+    // Carica le liste dell'ultimo Build e i parametri del blocco "Lighting"
+    void Upload(glm::vec3 const &sunDirection, glm::vec3 const &sunColor, glm::vec3 const &ambient, float tileWidth, float tileHeight) {
+        UploadBuffer(0, GL_RGBA32F, lightData.data(), lightData.size() * sizeof(glm::vec4));
+        UploadBuffer(1, GL_RG32UI, clusterData.data(), clusterData.size() * sizeof(unsigned int));
+        UploadBuffer(2, GL_R32UI, indices.data(), indices.size() * sizeof(unsigned int));
+
+        LightingBlock block;
+        block.clusterDims[0] = tilesX; block.clusterDims[1] = tilesY;
+        block.clusterDims[2] = slicesZ; block.clusterDims[3] = (unsigned int)(lightData.size() / 2);
+        block.clusterParams = glm::vec4(logScale, logBias, tileWidth, tileHeight);
+        block.sunDirection  = glm::vec4(glm::normalize(sunDirection), 0.0f);
+        block.sunColor      = glm::vec4(sunColor, 0.0f);
+        block.ambientColor  = glm::vec4(ambient, 0.0f);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        renderStats.bufferBytes += sizeof(block);
+    }
+
+    // Lega texture buffer e blocco "Lighting" ai punti fissi letti da lighting.glsl
+    // (possono esistere più griglie: forward clusterizzato e tile del deferred)
+    void Bind() {
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTING_UBO_BINDING, UBO);
+        const unsigned int units[3] = { LIGHT_DATA_UNIT, CLUSTER_DATA_UNIT, LIGHT_INDEX_UNIT };
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + units[i]);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        renderStats.textureBinds += 3;
+    }
+
+private:
+    // Layout std140 del blocco "Lighting" di lighting.glsl
+    struct LightingBlock {
+        unsigned int clusterDims[4]; // tilesX, tilesY, slicesZ, numero luci
+        glm::vec4 clusterParams;     // logScale, logBias, larghezza/altezza tile in pixel
+        glm::vec4 sunDirection;
+        glm::vec4 sunColor;
+        glm::vec4 ambientColor;
+    };
+
+    struct Range { int x0, x1, y0, y1, z0, z1; };
+
+    // Liste di una fetta, costruite da un solo thread
+    struct SliceList {
+        std::vector<unsigned int> counts, offsets, indices;
+    };
+
+    float fovY = 0.0f, aspect = 0.0f, zNear = 0.0f, zFar = 0.0f;
+    float tanX = 1.0f, tanY = 1.0f, logScale = 1.0f, logBias = 0.0f;
+    std::vector<glm::vec3> clusterMin, clusterMax;
+
+    std::vector<glm::vec4> viewLights;
+    std::vector<Range> ranges;
+    std::vector<SliceList> sliceLists;
+    std::vector<unsigned int> clusterData, indices;
+    std::vector<glm::vec4> lightData;
+
+    unsigned int buffers[3] = { 0, 0, 0 }, textures[3] = { 0, 0, 0 };
+    size_t capacity[3] = { 0, 0, 0 };
+    unsigned int UBO = 0;
+
+    unsigned int Index(unsigned int x, unsigned int y, unsigned int z) const {
+        return (z * tilesY + y) * tilesX + x;
+    }
+
+    float SliceDepth(unsigned int z) const {
+        return zNear * std::pow(zFar / zNear, (float)z / slicesZ);
+    }
+
+    int DepthSlice(float depth) const {
+        return (int)std::floor(std::log(depth) * logScale - logBias);
+    }
+
+    // Intervallo conservativo di cluster coperti dalla sfera di una luce
+    Range LightRange(glm::vec4 const &l) const {
+        Range r = { 0, -1, 0, -1, 0, -1 };
+        float depth = -l.z;
+        float dMin = std::max(depth - l.w, zNear), dMax = std::min(depth + l.w, zFar);
+        if (dMin > dMax)
+            return r;
+        r.z0 = std::max(DepthSlice(dMin), 0);
+        r.z1 = std::min(DepthSlice(dMax), (int)slicesZ - 1);
+
+        // Estremi in NDC del box della sfera: il minimo/massimo di x/d dipende dal segno
+        auto ndc = [&](float lo, float hi, float tanA, float &outLo, float &outHi) {
+            outLo = lo / ((lo < 0.0f ? dMin : dMax) * tanA);
+            outHi = hi / ((hi > 0.0f ? dMin : dMax) * tanA);
+        };
+        float x0, x1, y0, y1;
+        ndc(l.x - l.w, l.x + l.w, tanX, x0, x1);
+        ndc(l.y - l.w, l.y + l.w, tanY, y0, y1);
+        r.x0 = std::max((int)std::floor((x0 * 0.5f + 0.5f) * tilesX), 0);
+        r.x1 = std::min((int)std::floor((x1 * 0.5f + 0.5f) * tilesX), (int)tilesX - 1);
+        r.y0 = std::max((int)std::floor((y0 * 0.5f + 0.5f) * tilesY), 0);
+        r.y1 = std::min((int)std::floor((y1 * 0.5f + 0.5f) * tilesY), (int)tilesY - 1);
+        if (r.x0 > r.x1 || r.y0 > r.y1)
+            r.z1 = r.z0 - 1; // fuori dallo schermo
+        return r;
+    }
+
+    void BuildSlice(unsigned int z) {
+        CPU_ZONE("ClusteredLighting::BuildSlice");
+        const unsigned int tiles = tilesX * tilesY;
+        SliceList &slice = sliceLists[z];
+        slice.counts.assign(tiles, 0);
+        slice.offsets.assign(tiles, 0);
+        slice.indices.clear();
+
+        // Due passate: conta, poi scrive negli offset (niente vector per cluster)
+        static thread_local std::vector<unsigned int> hits;
+        hits.clear();
+        for (size_t i = 0; i < ranges.size(); i++) {
+            Range const &r = ranges[i];
+            if ((int)z < r.z0 || (int)z > r.z1)
+                continue;
+            glm::vec3 center(viewLights[i]);
+            float radius2 = viewLights[i].w * viewLights[i].w;
+            for (int y = r.y0; y <= r.y1; y++) {
+                for (int x = r.x0; x <= r.x1; x++) {
+                    unsigned int c = Index(x, y, z);
+                    // Distanza sfera-AABB
+                    glm::vec3 closest = glm::clamp(center, clusterMin[c], clusterMax[c]);
+                    glm::vec3 d = center - closest;
+                    if (glm::dot(d, d) <= radius2) {
+                        unsigned int t = y * tilesX + x;
+                        slice.counts[t]++;
+                        hits.push_back(t);
+                        hits.push_back((unsigned int)i);
+                    }
+                }
+            }
+        }
+        unsigned int total = 0;
+        for (unsigned int t = 0; t < tiles; t++) {
+            slice.offsets[t] = total;
+            total += slice.counts[t];
+        }
+        slice.indices.resize(total);
+        std::vector<unsigned int> cursor(slice.offsets);
+        for (size_t h = 0; h < hits.size(); h += 2)
+            slice.indices[cursor[hits[h]]++] = hits[h + 1];
+    }
+
+    // Orphaning del buffer quando cresce, altrimenti semplice sub-upload
+    void UploadBuffer(int i, GLenum format, const void *data, size_t size) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        size_t needed = std::max(size, (size_t)16);
+        if (needed > capacity[i]) {
+            gpuMemory.bufferBytes += (long long)(needed * 2) - (long long)capacity[i];
+            capacity[i] = needed * 2;
+            glBufferData(GL_TEXTURE_BUFFER, capacity[i], NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, format, buffers[i]);
+        }
+        if (size > 0)
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        renderStats.bufferBytes += size;
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
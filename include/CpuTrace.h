@@ -0,0 +1,150 @@
+#ifndef CPU_TRACE_H
+#define CPU_TRACE_H
+
+// --- ZONE DI STRUMENTAZIONE CPU ---
+// CPU_ZONE("nome") misura lo scope corrente e lo registra nel buffer del thread
+// che lo esegue (niente lock nel percorso caldo). Alla fine Export() scrive un
+// file JSON nel formato Trace Event di Chrome, da aprire con chrome://tracing
+// o ui.perfetto.dev. Il nome deve essere una stringa letterale.
+//
+// Costo: compilato senza CPU_TRACE (opzione CMake) la macro sparisce del
+// tutto; compilato ma senza registrazione attiva costa un load atomico.
+
+#ifdef CPU_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CpuTrace {
+public:
+    struct Event {
+        const char *name;
+        long long startNs;
+        long long durationNs;
+    };
+
+    // Oltre questo numero di eventi per thread si smette di registrare
+    static const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+    static CpuTrace &Get() {
+        static CpuTrace instance;
+        return instance;
+    }
+
+    void Start() { recording.store(true, std::memory_order_relaxed); }
+    void Stop() { recording.store(false, std::memory_order_relaxed); }
+    bool Recording() const { return recording.load(std::memory_order_relaxed); }
+
+    static long long Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Record(const char *name, long long startNs, long long endNs) {
+        ThreadBuffer &buffer = Local();
+        if (buffer.events.size() < MAX_EVENTS_PER_THREAD)
+            buffer.events.push_back({ name, startNs, endNs - startNs });
+    }
+
+    // Nome leggibile del thread corrente nella traccia (es. "main")
+    void SetThreadName(std::string const &name) { Local().name = name; }
+
+    // Da chiamare a thread di lavoro terminati (o fermi)
+    bool Export(std::string const &path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        FILE *file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            std::printf("ERRORE::TRACE:: impossibile scrivere %s\n", path.c_str());
+            return false;
+        }
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        size_t count = 0;
+        for (auto const &buffer : buffers) {
+            if (!buffer->name.empty()) {
+                std::fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                             first ? "" : ",\n", buffer->id, buffer->name.c_str());
+                first = false;
+            }
+            for (Event const &event : buffer->events) {
+                // Chrome vuole i microsecondi; i decimali conservano la risoluzione
+                std::fprintf(file, "%s{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             first ? "" : ",\n", event.name, buffer->id,
+                             (event.startNs - origin) / 1000.0, event.durationNs / 1000.0);
+                first = false;
+                count++;
+            }
+        }
+        std::fprintf(file, "\n]}\n");
+        std::fclose(file);
+        std::printf("TRACE: %zu zone di %zu thread in %s\n", count, buffers.size(), path.c_str());
+        return true;
+    }
+
+private:
+    struct ThreadBuffer {
+        unsigned int id = 0;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    std::atomic<bool> recording{ false };
+    long long origin = Now();
+    std::mutex mutex;
+    // I buffer sopravvivono ai thread (quelli del clustered lighting sono temporanei)
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    ThreadBuffer &Local() {
+        thread_local ThreadBuffer *local = nullptr;
+        if (!local) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            local = buffers.back().get();
+            local->id = (unsigned int)buffers.size();
+            local->events.reserve(4096);
+        }
+        return *local;
+    }
+};
+
+class CpuZone {
+public:
+    explicit CpuZone(const char *name) : name(CpuTrace::Get().Recording() ? name : nullptr) {
+        if (this->name)
+            start = CpuTrace::Now();
+    }
+    ~CpuZone() {
+        if (name)
+            CpuTrace::Get().Record(name, start, CpuTrace::Now());
+    }
+
+private:
+    const char *name;
+    long long start = 0;
+};
+
+#define CPU_TRACE_CONCAT2(a, b) a##b
+#define CPU_TRACE_CONCAT(a, b) CPU_TRACE_CONCAT2(a, b)
+#define CPU_ZONE(name) CpuZone CPU_TRACE_CONCAT(cpuZone_, __LINE__)(name)
+#define CPU_TRACE_START() CpuTrace::Get().Start()
+#define CPU_TRACE_STOP() CpuTrace::Get().Stop()
+#define CPU_TRACE_THREAD(name) CpuTrace::Get().SetThreadName(name)
+#define CPU_TRACE_EXPORT(path) CpuTrace::Get().Export(path)
+
+#else
+
+#define CPU_ZONE(name) ((void)0)
+#define CPU_TRACE_START() ((void)0)
+#define CPU_TRACE_STOP() ((void)0)
+#define CPU_TRACE_THREAD(name) ((void)0)
+#define CPU_TRACE_EXPORT(path) ((void)0)
+
+#endif
+
+#endif
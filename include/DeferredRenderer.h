@@ -0,0 +1,136 @@
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ClusteredLighting.h"
+#include "RenderStats.h"
+#include "ShaderLibrary.h"
+
+#include <iostream>
+
+// Unità texture fisse del G-buffer lette da deferred_light.frag
+const unsigned int GBUFFER_ALBEDO_UNIT = 12;
+const unsigned int GBUFFER_NORMAL_UNIT = 13;
+const unsigned int GBUFFER_DEPTH_UNIT  = 14;
+
+// --- PERCORSO DEFERRED ---
+// Alternativa al forward: il pass geometrico scrive un G-buffer compatto
+// (albedo RGBA8 + normale ottaedrica RG16 + profondità, 8 byte/pixel di colore)
+// e un solo pass a schermo intero calcola la luce una volta per pixel, invece
+// di una per ogni fragment sovrapposto del fogliame. Le luci puntiformi arrivano
+// da liste per tile di 16x16 pixel, costruite con lo stesso codice del clustered.
+class DeferredRenderer {
+public:
+    static const unsigned int TILE_SIZE = 16;
+
+    // Griglia 2D di tile (una sola fetta in profondità)
+    ClusteredLighting tiles;
+
+    int width = 0, height = 0;
+
+    void Create(int width, int height) {
+        glGenFramebuffers(1, &FBO);
+        glGenTextures(1, &albedo);
+        glGenTextures(1, &normal);
+        glGenTextures(1, &depth);
+        glGenVertexArrays(1, &fullscreenVAO);
+        tiles.Create();
+        Resize(width, height);
+    }
+
+    void Resize(int width, int height) {
+        if (width == this->width && height == this->height)
+            return;
+        gpuMemory.targetBytes -= MemoryBytes();
+        this->width = width;
+        this->height = height;
+        tiles.Resize((width + TILE_SIZE - 1) / TILE_SIZE, (height + TILE_SIZE - 1) / TILE_SIZE, 1);
+        gpuMemory.targetBytes += MemoryBytes();
+
+        Allocate(albedo, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        Allocate(normal, GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+        // Stesso formato del framebuffer di default, così la profondità si può copiare
+        Allocate(depth, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        const GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, attachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERRORE::DEFERRED:: G-buffer incompleto" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Byte di memoria video del G-buffer (per il confronto col forward)
+    size_t MemoryBytes() const { return (size_t)width * height * (4 + 4 + 4); }
+
+    // Inizio del pass geometrico: disegnare poi la scena con la famiglia "gbuffer"
+    void BeginGeometry() {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, width, height);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Pass di luce verso il framebuffer attivo prima di BeginGeometry; alla fine
+    // copia anche la profondità, così eventuali pass forward successivi funzionano
+    void LightingPass(ShaderLibrary &shaders, glm::mat4 const &view, glm::mat4 const &projection, unsigned int features = 0) {
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        unsigned int program = shaders.Get("deferred", features);
+        if (program) {
+            glm::mat4 invViewProjection = glm::inverse(projection * view);
+            glUseProgram(program);
+            glUniformMatrix4fv(glGetUniformLocation(program, "invViewProjection"), 1, GL_FALSE, &invViewProjection[0][0]);
+
+            const unsigned int units[3] = { GBUFFER_ALBEDO_UNIT, GBUFFER_NORMAL_UNIT, GBUFFER_DEPTH_UNIT };
+            const unsigned int textures[3] = { albedo, normal, depth };
+            for (int i = 0; i < 3; i++) {
+                glActiveTexture(GL_TEXTURE0 + units[i]);
+                glBindTexture(GL_TEXTURE_2D, textures[i]);
+            }
+            glActiveTexture(GL_TEXTURE0);
+
+            glDisable(GL_DEPTH_TEST);
+            glBindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glEnable(GL_DEPTH_TEST);
+
+            renderStats.drawCalls++;
+            renderStats.instances++;
+            renderStats.triangles++;
+            renderStats.vertices += 3;
+            renderStats.programBinds++;
+            renderStats.vaoBinds++;
+            renderStats.textureBinds += 3;
+            renderStats.uniformUploads++;
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+    }
+
+private:
+    unsigned int FBO = 0, albedo = 0, normal = 0, depth = 0;
+    unsigned int fullscreenVAO = 0;
+    GLint target = 0;
+
+    void Allocate(unsigned int texture, GLenum internalFormat, GLenum format, GLenum type) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
+
+#endif
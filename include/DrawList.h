@@ -0,0 +1,150 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "RenderStats.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Una draw call da emettere: mesh 'mesh' dell'entità alla riga 'object'
+struct DrawItem {
+    uint64_t key;          // ordine di invio, vedi DrawList::SortKey
+    unsigned int object;   // riga in SceneComponents
+    unsigned int mesh;     // indice in Model::meshes
+};
+
+// Tratto contiguo di 'items' con la stessa variante di shader (stesso programma)
+struct DrawBatch {
+    unsigned int features; // bit di variante delle mesh, già filtrati dalla maschera di Build
+    size_t begin, end;     // [begin, end) in DrawList::items
+};
+
+// --- LISTE DI DISEGNO COSTRUITE IN PARALLELO ---
+// Culling (LOD_HIDDEN e frustum) e chiavi di ordinamento si calcolano sui
+// thread del job system, a blocchi di righe della scena: ogni blocco scrive
+// nella sua lista, senza lock. Le liste si uniscono nell'ordine dei blocchi e
+// si ordinano per chiave con riga e mesh come spareggio, quindi il risultato
+// non dipende da quale thread ha fatto cosa. Solo Submit() chiama OpenGL e
+// resta sul thread del contesto.
+class DrawList {
+public:
+    std::vector<DrawItem> items;
+    std::vector<DrawBatch> batches; // items raggruppati per variante, nell'ordine di invio
+    unsigned int objectsPerJob = 1024;
+    unsigned int culled = 0; // entità nascoste o fuori dal frustum nell'ultimo Build
+
+    // Chiave a 64 bit: variante di shader (cambio di programma, il più caro),
+    // poi texture del materiale, poi distanza dalla camera (vicino -> lontano,
+    // così l'early-z scarta i fragment nascosti)
+    static uint64_t SortKey(unsigned int features, unsigned int texture, float distance) {
+        uint32_t depth;
+        std::memcpy(&depth, &distance, sizeof(depth)); // float positivi: i bit sono già in ordine
+        return ((uint64_t)(features & 0xFFu) << 56) | ((uint64_t)(texture & 0xFFFFFFu) << 32) | depth;
+    }
+
+    // 'mask' filtra i bit delle mesh che il pass non usa, come in Model::Draw
+    void Build(SceneComponents const &scene, glm::mat4 const &viewProjection,
+               glm::vec3 const &cameraPosition, unsigned int mask = ~0u) {
+        CPU_ZONE("DrawList::Build");
+        Frustum frustum(viewProjection);
+        size_t chunkCount = (scene.Size() + objectsPerJob - 1) / objectsPerJob;
+        chunks.resize(chunkCount);
+
+        jobs.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                CPU_ZONE("culling");
+                Chunk &chunk = chunks[c];
+                chunk.items.clear();
+                chunk.culled = 0;
+                size_t last = std::min(scene.Size(), (c + 1) * objectsPerJob);
+                for (size_t o = c * objectsPerJob; o < last; o++) {
+                    AABB const &world = scene.bounds[o];
+                    if (scene.lods[o] == LOD_HIDDEN || !frustum.Intersects(world)) {
+                        chunk.culled++;
+                        continue;
+                    }
+                    float distance = glm::length(world.Center() - cameraPosition);
+                    std::vector<Mesh> const &meshes = scene.models[o]->meshes;
+                    for (unsigned int m = 0; m < meshes.size(); m++) {
+                        unsigned int texture = meshes[m].textures.empty() ? 0 : meshes[m].textures[0].id;
+                        chunk.items.push_back({ SortKey(meshes[m].features & mask, texture, distance), (unsigned int)o, m });
+                    }
+                }
+            }
+        });
+
+        // Unione nell'ordine dei blocchi
+        items.clear();
+        culled = 0;
+        for (Chunk const &chunk : chunks) {
+            items.insert(items.end(), chunk.items.begin(), chunk.items.end());
+            culled += chunk.culled;
+        }
+        CPU_ZONE("sort");
+        std::sort(items.begin(), items.end(), [](DrawItem const &a, DrawItem const &b) {
+            if (a.key != b.key) return a.key < b.key;
+            if (a.object != b.object) return a.object < b.object;
+            return a.mesh < b.mesh;
+        });
+
+        // La variante sta negli 8 bit alti della chiave: dopo l'ordinamento
+        // ognuna occupa un tratto solo
+        batches.clear();
+        for (size_t i = 0; i < items.size(); i++) {
+            unsigned int variant = (unsigned int)(items[i].key >> 56);
+            if (batches.empty() || batches.back().features != variant)
+                batches.push_back({ variant, i, i });
+            batches.back().end = i + 1;
+        }
+    }
+
+    // Sul thread GL: programma e posizione della matrice model si risolvono una
+    // volta per batch, la matrice si carica solo quando cambia l'oggetto.
+    // Le varianti arrivano da Build, maschera compresa. Restituisce le draw call emesse.
+    unsigned int Submit(SceneComponents const &scene, ShaderLibrary &shaders, std::string const &family,
+                        unsigned int features = 0) const {
+        CPU_ZONE("DrawList::Submit");
+        unsigned int draws = 0;
+        for (DrawBatch const &batch : batches) {
+            unsigned int program = shaders.Get(family, batch.features | features);
+            if (!program)
+                continue; // variante non ancora compilata: salta un frame
+            glUseProgram(program);
+            renderStats.programBinds++;
+            int modelLocation = glGetUniformLocation(program, "model");
+            unsigned int currentObject = ~0u;
+            for (size_t i = batch.begin; i < batch.end; i++) {
+                DrawItem const &item = items[i];
+                if (item.object != currentObject) {
+                    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &scene.transforms[item.object][0][0]);
+                    currentObject = item.object;
+                    renderStats.uniformUploads++;
+                }
+                scene.models[item.object]->meshes[item.mesh].Draw(program);
+                draws++;
+            }
+        }
+        renderStats.culledObjects += culled;
+        return draws;
+    }
+
+private:
+    struct Chunk {
+        std::vector<DrawItem> items;
+        unsigned int culled = 0;
+    };
+    std::vector<Chunk> chunks; // riusati tra i frame per non riallocare
+};
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef ENTITY_REGISTRY_H
+#define ENTITY_REGISTRY_H
+
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Scene.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+#include "TransformKernel.h"
+
+#include <cstdint>
+#include <vector>
+
+// --- ENTITÀ DELLA SCENA ---
+// Le componenti stanno in SceneComponents (SoA, righe compatte). Una tabella
+// indice -> riga rende O(1) sia la creazione (indice dalla free list, riga in
+// coda) sia la distruzione (l'ultima riga prende il posto di quella tolta).
+// Le righe quindi non sono stabili: fuori da qui si conservano gli Entity.
+class EntityRegistry {
+public:
+    // Distanze (dal box) a cui si passa al LOD successivo; oltre l'ultima l'entità è LOD_HIDDEN
+    std::vector<float> lodDistances = { 50.0f, 100.0f, 250.0f };
+
+    void Reserve(size_t count) {
+        components.entities.reserve(count);
+        components.transforms.reserve(count);
+        components.models.reserve(count);
+        components.localBounds.reserve(count);
+        components.bounds.reserve(count);
+        components.lods.reserve(count);
+        components.flags.reserve(count);
+        components.names.reserve(count);
+    }
+
+    Entity Create(Model *model, glm::mat4 const &transform, AABB const &localBounds, bool isStatic = true, const char *name = "") {
+        Entity entity;
+        if (!freeIndices.empty()) {
+            entity.index = freeIndices.back();
+            freeIndices.pop_back();
+        } else {
+            entity.index = (uint32_t)rows.size();
+            rows.push_back(NO_ROW);
+            generations.push_back(0);
+        }
+        entity.generation = generations[entity.index];
+        rows[entity.index] = (uint32_t)components.Size();
+
+        components.entities.push_back(entity);
+        components.transforms.push_back(transform);
+        components.models.push_back(model);
+        components.localBounds.push_back(localBounds);
+        components.bounds.push_back(localBounds.Transform(transform));
+        components.lods.push_back(0);
+        components.flags.push_back(isStatic ? ENTITY_STATIC : 0);
+        components.names.push_back(name);
+        layoutVersion++;
+        return entity;
+    }
+
+    Entity Create(SceneObject const &object) {
+        return Create(object.model, object.transform, object.model->bounds, object.isStatic, object.name);
+    }
+
+    void Destroy(Entity entity) {
+        if (!Alive(entity))
+            return;
+        uint32_t row = rows[entity.index];
+        uint32_t last = (uint32_t)components.Size() - 1;
+        if (row != last) {
+            MoveRow(last, row);
+            rows[components.entities[row].index] = row;
+        }
+        PopRow();
+        rows[entity.index] = NO_ROW;
+        generations[entity.index]++;
+        freeIndices.push_back(entity.index);
+        layoutVersion++;
+    }
+
+    bool Alive(Entity entity) const {
+        return entity.index < rows.size() && rows[entity.index] != NO_ROW && generations[entity.index] == entity.generation;
+    }
+
+    void Clear() {
+        for (Entity const &entity : std::vector<Entity>(components.entities))
+            Destroy(entity);
+    }
+
+    size_t Size() const { return components.Size(); }
+    SceneComponents const &Components() const { return components; }
+
+    // Riga corrente dell'entità (valida fino alla prossima Destroy)
+    uint32_t Row(Entity entity) const { return rows[entity.index]; }
+
+    glm::mat4 const &Transform(Entity entity) const { return components.transforms[Row(entity)]; }
+
+    void SetTransform(Entity entity, glm::mat4 const &transform) {
+        uint32_t row = Row(entity);
+        components.transforms[row] = transform;
+        components.bounds[row] = components.localBounds[row].Transform(transform);
+    }
+
+    // Per aggiornare molte trasformazioni insieme; poi va chiamato UpdateBounds().
+    // Le entità statiche non si spostano (vedi DynamicRows).
+    std::vector<glm::mat4> &Transforms() { return components.transforms; }
+
+    // Cambia a ogni Create/Destroy: finché resta uguale lo sono anche le righe
+    uint64_t LayoutVersion() const { return layoutVersion; }
+
+    // Righe delle entità dinamiche, le sole la cui trasformazione può cambiare
+    // (le statiche stanno ferme: ShadowMaps ne tiene le ombre in cache)
+    std::vector<uint32_t> const &DynamicRows() const {
+        if (dynamicRowsVersion != layoutVersion) {
+            dynamicRows.clear();
+            for (size_t i = 0; i < components.Size(); i++)
+                if (!components.IsStatic(i))
+                    dynamicRows.push_back((uint32_t)i);
+            dynamicRowsVersion = layoutVersion;
+        }
+        return dynamicRows;
+    }
+
+    // Aggiorna 'out', copia delle componenti fatta alla versione 'version'. Con
+    // le stesse righe si ricopiano solo trasformazioni e box delle righe
+    // dinamiche e i LOD; dopo una Create/Destroy tutto (nella memoria già allocata).
+    void CopyTo(SceneComponents &out, uint64_t &version) const {
+        CPU_ZONE("EntityRegistry::CopyTo");
+        if (version != layoutVersion) {
+            out = components;
+            version = layoutVersion;
+            return;
+        }
+        for (uint32_t row : DynamicRows()) {
+            out.transforms[row] = components.transforms[row];
+            out.bounds[row] = components.bounds[row];
+        }
+        out.lods = components.lods;
+    }
+
+    // --- SISTEMI (in parallelo sul job system, a blocchi di righe contigue) ---
+
+    void UpdateBounds() {
+        CPU_ZONE("EntityRegistry::UpdateBounds");
+        jobs.ParallelFor(components.Size(), ROWS_PER_JOB, [this](size_t begin, size_t end) {
+            TransformBounds(components.transforms.data(), components.localBounds.data(), begin, end,
+                            components.bounds.data(), nullptr);
+        });
+    }
+
+    // LOD dalla distanza tra la camera e il box in coordinate mondo
+    void UpdateLod(glm::vec3 const &cameraPosition) {
+        CPU_ZONE("EntityRegistry::UpdateLod");
+        jobs.ParallelFor(components.Size(), ROWS_PER_JOB, [this, cameraPosition](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                AABB const &box = components.bounds[i];
+                float distance = glm::length(glm::max(glm::max(box.Min - cameraPosition, cameraPosition - box.Max), glm::vec3(0.0f)));
+                uint8_t lod = 0;
+                while (lod < lodDistances.size() && distance > lodDistances[lod])
+                    lod++;
+                components.lods[i] = lod < lodDistances.size() ? lod : LOD_HIDDEN;
+            }
+        });
+    }
+
+private:
+    static constexpr uint32_t NO_ROW = ~0u;
+    static constexpr size_t ROWS_PER_JOB = 4096;
+
+    SceneComponents components;
+    std::vector<uint32_t> rows;        // indice entità -> riga, NO_ROW se libera
+    std::vector<uint32_t> generations; // per indice entità
+    std::vector<uint32_t> freeIndices;
+    uint64_t layoutVersion = 1; // 0 = copia mai fatta (vedi CopyTo)
+    mutable std::vector<uint32_t> dynamicRows;
+    mutable uint64_t dynamicRowsVersion = 0;
+
+    void MoveRow(uint32_t from, uint32_t to) {
+        components.entities[to] = components.entities[from];
+        components.transforms[to] = components.transforms[from];
+        components.models[to] = components.models[from];
+        components.localBounds[to] = components.localBounds[from];
+        components.bounds[to] = components.bounds[from];
+        components.lods[to] = components.lods[from];
+        components.flags[to] = components.flags[from];
+        components.names[to] = components.names[from];
+    }
+
+    void PopRow() {
+        components.entities.pop_back();
+        components.transforms.pop_back();
+        components.models.pop_back();
+        components.localBounds.pop_back();
+        components.bounds.pop_back();
+        components.lods.pop_back();
+        components.flags.pop_back();
+        components.names.pop_back();
+    }
+};
+
+#endif
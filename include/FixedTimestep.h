@@ -0,0 +1,106 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Camera.h"
+#include "EntityRegistry.h"
+#include "Scene.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <vector>
+
+// --- SIMULAZIONE A PASSO FISSO ---
+// Il tempo reale si accumula e la simulazione avanza a passi di 'step' secondi,
+// quindi movimento e costo non dipendono dal frame rate. Dopo un blocco lungo
+// (caricamento, finestra trascinata) si eseguono al massimo 'maxSteps' passi e
+// il tempo restante si scarta: niente spirale in cui recuperare costa più del
+// tempo che si recupera. Il frame si disegna interpolando tra gli ultimi due
+// stati con Alpha().
+class FixedTimestep {
+public:
+    float step;
+    unsigned int maxSteps;
+    unsigned long steps = 0;        // passi eseguiti dall'avvio
+    unsigned long droppedSteps = 0; // passi scartati dal limite di recupero
+
+    explicit FixedTimestep(float step = 1.0f / 60.0f, unsigned int maxSteps = 5) : step(step), maxSteps(maxSteps) {}
+
+    // Aggiunge il tempo reale trascorso e restituisce quanti passi eseguire ora
+    unsigned int Advance(float elapsed) {
+        accumulator += elapsed;
+        unsigned int count = (unsigned int)(accumulator / step);
+        if (count > maxSteps) {
+            droppedSteps += count - maxSteps;
+            count = maxSteps;
+            accumulator = 0.0f;
+        } else {
+            accumulator -= count * step;
+        }
+        steps += count;
+        return count;
+    }
+
+    // Frazione del passo successivo già trascorsa, in [0, 1)
+    float Alpha() const { return accumulator / step; }
+
+    // Tempo simulato dello stato interpolato (un passo indietro rispetto all'ultimo)
+    float InterpolatedTime() const { return steps ? ((float)(steps - 1) + Alpha()) * step : 0.0f; }
+
+private:
+    float accumulator = 0.0f;
+};
+
+// Trasformazione tra 'a' e 'b': traslazione e scala lineari, rotazione con slerp.
+// Le matrici uguali (oggetti fermi, quasi tutti) si copiano senza conti.
+inline glm::mat4 InterpolateTransform(glm::mat4 const &a, glm::mat4 const &b, float t) {
+    if (a == b)
+        return b;
+    glm::vec3 scaleA(glm::length(glm::vec3(a[0])), glm::length(glm::vec3(a[1])), glm::length(glm::vec3(a[2])));
+    glm::vec3 scaleB(glm::length(glm::vec3(b[0])), glm::length(glm::vec3(b[1])), glm::length(glm::vec3(b[2])));
+    glm::mat3 rotationA(glm::vec3(a[0]) / scaleA.x, glm::vec3(a[1]) / scaleA.y, glm::vec3(a[2]) / scaleA.z);
+    glm::mat3 rotationB(glm::vec3(b[0]) / scaleB.x, glm::vec3(b[1]) / scaleB.y, glm::vec3(b[2]) / scaleB.z);
+    glm::mat3 rotation = glm::mat3_cast(glm::slerp(glm::quat_cast(rotationA), glm::quat_cast(rotationB), t));
+    glm::vec3 scale = glm::mix(scaleA, scaleB, t);
+
+    glm::mat4 out(1.0f);
+    for (int i = 0; i < 3; i++)
+        out[i] = glm::vec4(rotation[i] * scale[i], 0.0f);
+    out[3] = glm::vec4(glm::mix(glm::vec3(a[3]), glm::vec3(b[3]), t), 1.0f);
+    return out;
+}
+
+// Scena interpolata in 'out', copia di 'current' aggiornata con CopyTo (quindi
+// 'outVersion' va conservata insieme a 'out'). Si interpolano solo le righe
+// dinamiche con la stessa entità nei due stati: create, distrutte o spostate
+// di riga nel passo compaiono già nello stato nuovo.
+inline void InterpolateScene(SceneComponents const &previous, EntityRegistry const &current, float t,
+                             SceneComponents &out, uint64_t &outVersion) {
+    CPU_ZONE("InterpolateScene");
+    current.CopyTo(out, outVersion);
+    SceneComponents const &now = current.Components();
+    std::vector<uint32_t> const &rows = current.DynamicRows();
+    jobs.ParallelFor(rows.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++) {
+            uint32_t i = rows[r];
+            if (i >= previous.Size() || previous.entities[i] != now.entities[i] || previous.transforms[i] == now.transforms[i])
+                continue;
+            out.transforms[i] = InterpolateTransform(previous.transforms[i], now.transforms[i], t);
+            out.bounds[i] = out.localBounds[i].Transform(out.transforms[i]);
+        }
+    });
+}
+
+// Posizione interpolata tra gli ultimi due passi; orientamento e zoom dalla
+// camera corrente perché arrivano dal mouse, evento per evento, e interpolarli
+// aggiungerebbe solo ritardo alla visuale
+inline Camera InterpolateCamera(Camera const &previous, Camera const &current, float t) {
+    Camera out = current;
+    out.Position = glm::mix(previous.Position, current.Position, t);
+    return out;
+}
+
+#endif
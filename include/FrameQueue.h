@@ -0,0 +1,71 @@
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include "Camera.h"
+#include "Scene.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct WorldCell; // WorldStreaming.h
+
+// Tutto ciò che serve al render thread per disegnare un frame, copiato dal
+// thread principale alla fine della simulazione: dopo il Push lo tocca solo il
+// render thread, che dopo averlo disegnato lo restituisce per essere riusato
+struct FrameSnapshot {
+    float time = 0.0f;            // secondi dall'avvio (animazione delle lucciole)
+    Camera camera;
+    int renderPath = 0;           // RenderPath in main.cpp
+    int width = 0, height = 0;    // framebuffer
+    SceneComponents scene;
+    uint64_t sceneVersion = 0;    // di 'scene', per EntityRegistry::CopyTo
+    std::vector<std::shared_ptr<const WorldCell>> cells; // celle del mondo residenti
+};
+
+// --- CODA SPSC SENZA LOCK ---
+// Un produttore (thread principale) e un consumatore (render thread) su un
+// anello di Capacity + 1 slot: head e tail avanzano ognuno da un solo thread,
+// quindi bastano due atomici con acquire/release. La capacità limita di quanti
+// frame la simulazione può precedere il rendering (latenza massima).
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    // Solo produttore. Falso se la coda è piena (l'elemento non viene spostato).
+    bool Push(T &&value) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % SLOTS;
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+        slots[tail] = std::move(value);
+        this->tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Solo consumatore. Falso se la coda è vuota.
+    bool Pop(T &value) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == tail.load(std::memory_order_acquire))
+            return false;
+        value = std::move(slots[head]);
+        this->head.store((head + 1) % SLOTS, std::memory_order_release);
+        return true;
+    }
+
+    // Solo produttore (dal consumatore il valore può essere già vecchio)
+    bool Full() const {
+        return (tail.load(std::memory_order_relaxed) + 1) % SLOTS == head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t SLOTS = Capacity + 1;
+    T slots[SLOTS];
+    // Su linee di cache diverse: ognuno è scritto da un thread diverso
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <string>
+
+// Il loader glad è generato solo per GL 3.3 core senza estensioni:
+// le funzioni più recenti che usiamo le carichiamo a mano qui, e sono
+// tutte opzionali (se mancano si torna al percorso 3.3 classico).
+
+// --- ARB_get_program_binary (core in GL 4.1) ---
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// --- KHR_parallel_shader_compile / ARB_parallel_shader_compile ---
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// --- EXT_texture_compression_s3tc (BC1/BC3), ARB_texture_compression_bptc (BC7, core in GL 4.2) ---
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+typedef void (APIENTRYP PFN_glGetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFN_glProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFN_glProgramParameteri)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFN_glMaxShaderCompilerThreads)(GLuint count);
+
+class GLExtensions {
+public:
+    // ARB_get_program_binary
+    bool programBinary = false;
+    PFN_glGetProgramBinary  GetProgramBinary  = nullptr;
+    PFN_glProgramBinary     ProgramBinary     = nullptr;
+    PFN_glProgramParameteri ProgramParameteri = nullptr;
+
+    // KHR_parallel_shader_compile: il driver compila su thread suoi e
+    // GL_COMPLETION_STATUS_KHR dice se un shader/programma è pronto senza bloccare
+    bool parallelShaderCompile = false;
+    PFN_glMaxShaderCompilerThreads MaxShaderCompilerThreads = nullptr;
+
+    // Formati compressi a blocchi oltre a RGTC (BC4/BC5, core dal 3.0)
+    bool textureS3TC = false;
+    bool textureBPTC = false;
+
+    // Da chiamare una volta, dopo gladLoadGLLoader e con il contesto attivo
+    void Load(GLADloadproc load) {
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        if (version(4, 1) || Has("GL_ARB_get_program_binary")) {
+            GetProgramBinary  = (PFN_glGetProgramBinary)load("glGetProgramBinary");
+            ProgramBinary     = (PFN_glProgramBinary)load("glProgramBinary");
+            ProgramParameteri = (PFN_glProgramParameteri)load("glProgramParameteri");
+
+            // Alcuni driver espongono l'estensione ma con zero formati: inutile
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            programBinary = GetProgramBinary && ProgramBinary && ProgramParameteri && formats > 0;
+        }
+
+        if (Has("GL_KHR_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFN_glMaxShaderCompilerThreads)load("glMaxShaderCompilerThreadsKHR");
+        else if (Has("GL_ARB_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFN_glMaxShaderCompilerThreads)load("glMaxShaderCompilerThreadsARB");
+        parallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+
+        textureS3TC = Has("GL_EXT_texture_compression_s3tc");
+        textureBPTC = version(4, 2) || Has("GL_ARB_texture_compression_bptc");
+    }
+
+    bool Has(const char *name) const {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, i);
+            if (ext && std::strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Stringa che identifica driver e GPU (cambia ad ogni aggiornamento driver)
+    std::string DriverString() const {
+        std::string id;
+        const char *vendor   = (const char *)glGetString(GL_VENDOR);
+        const char *renderer = (const char *)glGetString(GL_RENDERER);
+        const char *ver      = (const char *)glGetString(GL_VERSION);
+        id += vendor ? vendor : "?";
+        id += "|";
+        id += renderer ? renderer : "?";
+        id += "|";
+        id += ver ? ver : "?";
+        return id;
+    }
+
+private:
+    GLint major = 3, minor = 3;
+
+    bool version(int maj, int min) const {
+        return major > maj || (major == maj && minor >= min);
+    }
+};
+
+// Istanza globale, riempita in main() subito dopo glad
+inline GLExtensions glExt;
+
+#endif
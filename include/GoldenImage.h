@@ -0,0 +1,237 @@
+#ifndef GOLDEN_IMAGE_H
+#define GOLDEN_IMAGE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Benchmarks.h"
+#include "Camera.h"
+#include "CameraPath.h"
+#include "GpuProfiler.h"
+#include "RenderStats.h"
+#include "RenderTarget.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// --- IMMAGINI DI RIFERIMENTO E BUDGET DI PRESTAZIONI ---
+// Per ogni scena un file di budget (es. golden/forest.budget) elenca le pose
+// fisse della camera e i limiti: l'harness rende ogni posa headless, la
+// confronta con golden/<scena>_<posa>.ppm e misura tempi e memoria.
+// Formato, una direttiva per riga ('#' = commento):
+//   scene forest
+//   size 640 360
+//   pose radura 0 3 15 -90 -5        (nome, x y z, yaw, pitch)
+//   delta_e 2.3                      (differenza Lab oltre cui un pixel "si vede")
+//   max_diff 0.005                   (frazione massima di pixel visibilmente diversi)
+//   frame_ms 33.3                    (p95 del frame, CPU e GPU; 0 = nessun limite)
+//   gpu_memory_mb 512                (stima di gpuMemory; 0 = nessun limite)
+//   cpu_memory_mb 2048               (picco di memoria residente; 0 = nessun limite)
+//   frames 120                       (frame misurati per posa)
+struct SceneBudget {
+    struct Pose {
+        std::string name;
+        CameraKey key;
+    };
+
+    std::string scene = "scena";
+    int width = 640, height = 360;
+    std::vector<Pose> poses;
+    double deltaE = 2.3;
+    double maxDiff = 0.005;
+    double frameMs = 0.0;
+    double gpuMemoryMb = 0.0;
+    double cpuMemoryMb = 0.0;
+    unsigned int frames = 120;
+
+    bool Load(std::string const &path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cout << "ERRORE::GOLDEN:: file di budget non trovato: " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string directive;
+            if (!(fields >> directive) || directive[0] == '#')
+                continue;
+            if (directive == "scene") fields >> scene;
+            else if (directive == "size") fields >> width >> height;
+            else if (directive == "delta_e") fields >> deltaE;
+            else if (directive == "max_diff") fields >> maxDiff;
+            else if (directive == "frame_ms") fields >> frameMs;
+            else if (directive == "gpu_memory_mb") fields >> gpuMemoryMb;
+            else if (directive == "cpu_memory_mb") fields >> cpuMemoryMb;
+            else if (directive == "frames") fields >> frames;
+            else if (directive == "pose") {
+                Pose pose;
+                fields >> pose.name >> pose.key.position.x >> pose.key.position.y >> pose.key.position.z >> pose.key.yaw >> pose.key.pitch;
+                if (fields) poses.push_back(pose);
+            }
+            else std::cout << "ATTENZIONE::GOLDEN:: direttiva sconosciuta '" << directive << "' in " << path << std::endl;
+        }
+        return !poses.empty();
+    }
+};
+
+// sRGB 8 bit -> CIELAB (D65): la distanza euclidea in Lab (ΔE76) approssima
+// la differenza percepita, ~2.3 è la soglia appena percettibile
+inline glm::vec3 SrgbToLab(unsigned char const *rgb) {
+    float c[3];
+    for (int i = 0; i < 3; i++) {
+        float v = rgb[i] / 255.0f;
+        c[i] = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+    }
+    float x = (0.4124f * c[0] + 0.3576f * c[1] + 0.1805f * c[2]) / 0.95047f;
+    float y = (0.2126f * c[0] + 0.7152f * c[1] + 0.0722f * c[2]);
+    float z = (0.0193f * c[0] + 0.1192f * c[1] + 0.9505f * c[2]) / 1.08883f;
+    auto f = [](float t) { return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f; };
+    float fx = f(x), fy = f(y), fz = f(z);
+    return glm::vec3(116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz));
+}
+
+struct ImageDiff {
+    double meanDeltaE = 0.0;
+    double maxDeltaE = 0.0;
+    double visibleFraction = 0.0; // pixel con ΔE oltre la soglia
+};
+
+// Confronta due immagini RGB della stessa dimensione; 'heatmap' (opzionale)
+// riceve un'immagine in scala di rossi proporzionale a ΔE
+inline ImageDiff CompareImages(std::vector<unsigned char> const &a, std::vector<unsigned char> const &b,
+                               double threshold, std::vector<unsigned char> *heatmap = nullptr) {
+    ImageDiff diff;
+    size_t pixels = std::min(a.size(), b.size()) / 3;
+    if (heatmap)
+        heatmap->assign(pixels * 3, 0);
+    size_t visible = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        double e = glm::length(SrgbToLab(&a[3 * i]) - SrgbToLab(&b[3 * i]));
+        diff.meanDeltaE += e;
+        diff.maxDeltaE = std::max(diff.maxDeltaE, e);
+        if (e > threshold)
+            visible++;
+        if (heatmap)
+            (*heatmap)[3 * i] = (unsigned char)std::min(255.0, e * 10.0);
+    }
+    if (pixels) {
+        diff.meanDeltaE /= pixels;
+        diff.visibleFraction = (double)visible / pixels;
+    }
+    return diff;
+}
+
+// Picco di memoria residente del processo in MB (0 dove non disponibile)
+inline double PeakResidentMb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+#endif
+    return 0.0;
+}
+
+// Esegue l'harness: per ogni posa confronto con la golden e budget dei tempi,
+// poi il budget di memoria. Le golden mancanti (o tutte, con 'update') vengono
+// scritte invece di confrontate. Immagini correnti e mappe delle differenze
+// finiscono in 'outputDirectory' (artefatti della CI). Ritorna 0 se tutto passa.
+inline int RunGoldenHarness(SceneBudget const &budget, std::string const &goldenDirectory, std::string const &outputDirectory,
+                            bool update, Camera &camera, RenderTarget &target, GpuProfiler &profiler,
+                            std::function<void(float)> const &renderFrame) {
+    int failures = 0;
+    profiler.recordHistory = true;
+
+    for (SceneBudget::Pose const &pose : budget.poses) {
+        camera.SetPose(pose.key.position, pose.key.yaw, pose.key.pitch);
+        std::string name = budget.scene + "_" + pose.name;
+
+        // Qualche frame per riempire le cache (ombre statiche) prima di catturare
+        for (int i = 0; i < 4; i++) {
+            target.Bind();
+            renderFrame(0.0f);
+        }
+        glFinish();
+        std::vector<unsigned char> image = target.ReadPixels();
+        WritePPM(outputDirectory + "/" + name + ".ppm", image, target.width, target.height);
+
+        std::string goldenPath = goldenDirectory + "/" + name + ".ppm";
+        std::vector<unsigned char> golden;
+        int goldenWidth = 0, goldenHeight = 0;
+        if (update) {
+            WritePPM(goldenPath, image, target.width, target.height);
+            std::printf("GOLDEN %-24s registrata in %s\n", name.c_str(), goldenPath.c_str());
+        } else if (!ReadPPM(goldenPath, golden, goldenWidth, goldenHeight)) {
+            // Senza riferimento non c'è confronto: è un fallimento, non una registrazione implicita
+            std::printf("GOLDEN %-24s FALLITA: manca %s (registrarla con --update-golden)\n", name.c_str(),
+                        goldenPath.c_str());
+            failures++;
+        } else if (goldenWidth != target.width || goldenHeight != target.height) {
+            std::printf("GOLDEN %-24s FALLITA: dimensione %dx%d invece di %dx%d\n", name.c_str(),
+                        goldenWidth, goldenHeight, target.width, target.height);
+            failures++;
+        } else {
+            std::vector<unsigned char> heatmap;
+            ImageDiff diff = CompareImages(image, golden, budget.deltaE, &heatmap);
+            bool pass = diff.visibleFraction <= budget.maxDiff;
+            std::printf("GOLDEN %-24s %s: %.3f%% pixel diversi (limite %.3f%%), ΔE medio %.3f, max %.1f\n", name.c_str(),
+                        pass ? "ok" : "FALLITA", 100.0 * diff.visibleFraction, 100.0 * budget.maxDiff, diff.meanDeltaE, diff.maxDeltaE);
+            if (!pass) {
+                WritePPM(outputDirectory + "/" + name + "_diff.ppm", heatmap, target.width, target.height);
+                failures++;
+            }
+        }
+
+        // Budget dei tempi alla stessa posa
+        std::vector<double> cpuMs;
+        profiler.Flush();
+        profiler.frameHistory.clear();
+        for (unsigned int i = 0; i < budget.frames; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            target.Bind();
+            renderFrame((float)i / 60.0f);
+            glFlush();
+            cpuMs.push_back(ElapsedMs(start));
+        }
+        glFinish();
+        profiler.Flush();
+        double cpuP95 = ComputePercentiles(cpuMs).p95;
+        double gpuP95 = ComputePercentiles(profiler.frameHistory).p95;
+        bool pass = budget.frameMs <= 0.0 || (cpuP95 <= budget.frameMs && gpuP95 <= budget.frameMs);
+        std::printf("BUDGET %-24s %s: p95 %.2f ms CPU, %.2f ms GPU (limite %.2f ms)\n", name.c_str(),
+                    pass ? "ok" : "FALLITO", cpuP95, gpuP95, budget.frameMs);
+        if (!pass)
+            failures++;
+    }
+
+    double gpuMb = gpuMemory.Total() / (1024.0 * 1024.0);
+    double cpuMb = PeakResidentMb();
+    bool gpuPass = budget.gpuMemoryMb <= 0.0 || gpuMb <= budget.gpuMemoryMb;
+    bool cpuPass = budget.cpuMemoryMb <= 0.0 || cpuMb <= budget.cpuMemoryMb;
+    std::printf("BUDGET %-24s %s: %.1f MB video stimati (limite %.1f), %.1f MB residenti (limite %.1f)\n",
+                (budget.scene + " memoria").c_str(), gpuPass && cpuPass ? "ok" : "FALLITO",
+                gpuMb, budget.gpuMemoryMb, cpuMb, budget.cpuMemoryMb);
+    if (!gpuPass || !cpuPass)
+        failures++;
+
+    std::printf("GOLDEN: %d controlli falliti\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// --- PROFILER GPU CON TIMER QUERY ---
+// Ogni scope (pass o singolo modello) mette un GL_TIMESTAMP all'inizio e alla
+// fine e misura anche il tempo CPU speso a emettere i comandi. I risultati si
+// leggono FRAMES frame dopo, quando la GPU li ha certamente prodotti: se non
+// sono ancora disponibili il frame si scarta invece di aspettare, quindi il
+// profiler non blocca mai la pipeline. Gli scope si annidano e prendono un
+// nome a percorso ("opaco/albero"); le medie mobili restano in 'timings'.
+class GpuProfiler {
+public:
+    static const unsigned int FRAMES = 3;        // frame in volo prima di leggere
+    static const unsigned int MAX_SCOPES = 128;  // scope per frame
+
+    struct Timing {
+        double gpuMs = 0.0;   // media mobile del tempo GPU
+        double cpuMs = 0.0;   // media mobile del tempo CPU di invio comandi
+        unsigned int depth = 0;
+        unsigned long samples = 0;
+    };
+
+    // Peso del nuovo campione nella media mobile esponenziale
+    double smoothing = 0.05;
+    bool enabled = true;
+
+    // Frame scartati perché le query non erano ancora pronte
+    unsigned long dropped = 0;
+
+    // Se attivo, il tempo GPU di ogni frame letto finisce in frameHistory (benchmark)
+    bool recordHistory = false;
+    std::vector<double> frameHistory;
+
+    void Create() {
+        for (Frame &frame : frames) {
+            glGenQueries(2 * MAX_SCOPES, frame.queries);
+            frame.scopes.reserve(MAX_SCOPES);
+        }
+    }
+
+    void BeginFrame() {
+        if (!enabled)
+            return;
+        Frame &frame = frames[frameIndex % FRAMES];
+        if (!frame.scopes.empty())
+            Collect(frame);
+        frame.scopes.clear();
+        stack.clear();
+        Begin("frame");
+    }
+
+    void EndFrame() {
+        if (!enabled)
+            return;
+        while (!stack.empty())
+            End();
+        frameIndex++;
+    }
+
+    void Begin(std::string const &name) {
+        if (!enabled)
+            return;
+        Frame &frame = frames[frameIndex % FRAMES];
+        // I figli diretti di "frame" non ne portano il prefisso
+        std::string path = name;
+        if (stack.size() > 1 && stack.back() >= 0)
+            path = frame.scopes[stack.back()].name + "/" + name;
+        // Pool pieno: lo scope si ignora ma End() deve restare bilanciato
+        if (frame.scopes.size() == MAX_SCOPES) {
+            stack.push_back(-1);
+            return;
+        }
+        Scope scope;
+        scope.name = path;
+        scope.depth = (unsigned int)stack.size();
+        scope.cpuStart = Clock::now();
+        glQueryCounter(frame.queries[2 * frame.scopes.size()], GL_TIMESTAMP);
+        stack.push_back((int)frame.scopes.size());
+        frame.scopes.push_back(scope);
+    }
+
+    void End() {
+        if (!enabled || stack.empty())
+            return;
+        int index = stack.back();
+        stack.pop_back();
+        if (index < 0)
+            return;
+        Frame &frame = frames[frameIndex % FRAMES];
+        glQueryCounter(frame.queries[2 * index + 1], GL_TIMESTAMP);
+        frame.scopes[index].cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - frame.scopes[index].cpuStart).count();
+    }
+
+    // Legge i frame ancora in volo (dopo un glFinish sono tutti disponibili)
+    void Flush() {
+        for (unsigned int i = 0; i < FRAMES; i++) {
+            Frame &frame = frames[(frameIndex + i) % FRAMES];
+            if (!frame.scopes.empty())
+                Collect(frame);
+            frame.scopes.clear();
+        }
+    }
+
+    Timing const *Find(std::string const &name) const {
+        auto it = timings.find(name);
+        return it != timings.end() ? &it->second : nullptr;
+    }
+
+    // Vero se la GPU impiega più della CPU a eseguire il frame
+    bool GpuBound() const {
+        Timing const *frame = Find("frame");
+        return frame && frame->gpuMs > frame->cpuMs;
+    }
+
+    // Tabella con gli scope nell'ordine in cui sono comparsi la prima volta
+    void Report(std::ostream &out) const {
+        out << std::fixed << std::setprecision(3);
+        out << std::left << std::setw(32) << "scope" << std::right << std::setw(10) << "GPU ms" << std::setw(10) << "CPU ms" << "\n";
+        for (std::string const &name : order) {
+            Timing const &t = timings.at(name);
+            out << std::left << std::setw(32) << (std::string(2 * t.depth, ' ') + name) << std::right
+                << std::setw(10) << t.gpuMs << std::setw(10) << t.cpuMs << "\n";
+        }
+        out << (GpuBound() ? "limitato dalla GPU" : "limitato dalla CPU") << ", " << dropped << " frame scartati\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    // Aggiunge il report corrente in coda al file di log
+    void WriteLog(std::string const &path) const {
+        std::ofstream out(path, std::ios::app);
+        if (!out) {
+            std::cout << "ERRORE::PROFILER:: impossibile scrivere " << path << std::endl;
+            return;
+        }
+        out << "--- frame " << frameIndex << " ---\n";
+        Report(out);
+    }
+
+    std::map<std::string, Timing> timings;
+
+private:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Scope {
+        std::string name;
+        unsigned int depth = 0;
+        Clock::time_point cpuStart;
+        double cpuMs = 0.0;
+    };
+
+    struct Frame {
+        unsigned int queries[2 * MAX_SCOPES] = {};
+        std::vector<Scope> scopes;
+    };
+
+    Frame frames[FRAMES];
+    std::vector<int> stack;
+    std::vector<std::string> order;
+    unsigned long frameIndex = 0;
+
+    void Collect(Frame &frame) {
+        // L'ultimo timestamp emesso è quello di fine "frame": se è pronto lo sono tutti
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            dropped++;
+            return;
+        }
+        for (size_t i = 0; i < frame.scopes.size(); i++) {
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(frame.queries[2 * i], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(frame.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+            Scope const &scope = frame.scopes[i];
+            auto it = timings.find(scope.name);
+            if (it == timings.end()) {
+                it = timings.emplace(scope.name, Timing()).first;
+                order.push_back(scope.name);
+            }
+            Timing &t = it->second;
+            double gpuMs = (double)(end - start) / 1.0e6;
+            if (i == 0 && recordHistory)
+                frameHistory.push_back(gpuMs);
+            float k = t.samples == 0 ? 1.0f : (float)smoothing;
+            t.gpuMs += (gpuMs - t.gpuMs) * k;
+            t.cpuMs += (scope.cpuMs - t.cpuMs) * k;
+            t.depth = scope.depth;
+            t.samples++;
+        }
+    }
+};
+
+// Scope con durata automatica: GpuScope scope(profiler, "ombre");
+class GpuScope {
+public:
+    GpuScope(GpuProfiler &profiler, std::string const &name) : profiler(profiler) { profiler.Begin(name); }
+    ~GpuScope() { profiler.End(); }
+
+private:
+    GpuProfiler &profiler;
+};
+
+#endif
@@ -0,0 +1,367 @@
+#ifndef GRASS_H
+#define GRASS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "Terrain.h"
+#include "RenderStats.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// --- ERBA ISTANZIATA ---
+// Ciuffi di fili d'erba da poche mesh procedurali (varianti), una per tile,
+// istanziati su tile di terreno attorno alla camera. Ogni istanza è un vec4
+// (x, z, rotazione, scala): la quota la legge grass.vert dalla heightmap del
+// terreno. Le tile entro 'radius' si generano sui thread di lavoro quando la
+// camera si avvicina e occupano uno slot di un unico buffer di istanze; quelle
+// che escono liberano lo slot.
+// Densità: le istanze di una tile sono in ordine casuale, quindi disegnarne le
+// prime N dirada in modo uniforme. La frazione scende da 1 a nearDistance a 0
+// a farDistance; nello shader ogni ciuffo si abbassa fino a sparire quando il
+// suo rango supera la frazione alla sua distanza (niente scatti), e il CPU
+// disegna solo i ranghi che possono essere visibili. Se il totale supera
+// instanceBudget tutte le frazioni scalano insieme: il costo GPU ha un tetto.
+class GrassField {
+public:
+    float tileSize = 16.0f;
+    unsigned int tuftsPerTile = 1024;   // 4 ciuffi per metro quadro
+    unsigned int bladesPerTuft = 7;
+    unsigned int variants = 3;          // mesh di ciuffo diverse, una per tile
+    float radius = 80.0f;               // tile generate e disegnate entro questa distanza
+    float nearDistance = 15.0f, farDistance = 80.0f;
+    unsigned int instanceBudget = 120000; // ciuffi disegnati al massimo per frame
+    float maxSlope = 35.0f;             // gradi: niente erba sulle pareti ripide
+    unsigned int seed = 1;
+
+    // Statistiche dell'ultimo frame
+    unsigned int tilesDrawn = 0, tuftsDrawn = 0;
+    float densityScale = 1.0f;
+
+    void Create(Terrain const &terrain, unsigned int seed) {
+        CPU_ZONE("GrassField::Create");
+        this->terrain = &terrain;
+        this->seed = seed;
+        int side = (int)std::ceil(2.0f * (radius + tileSize) / tileSize) + 1;
+        slotCount = (unsigned int)(side * side);
+        freeSlots.clear();
+        for (unsigned int i = slotCount; i > 0; i--)
+            freeSlots.push_back(i - 1);
+
+        glGenBuffers(1, &instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (size_t)slotCount * tuftsPerTile * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+        gpuMemory.bufferBytes += (long long)slotCount * tuftsPerTile * sizeof(glm::vec4);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        for (unsigned int v = 0; v < variants; v++)
+            meshes.push_back(CreateTuft(seed * 31u + v));
+        gradient = CreateGradient();
+        std::cout << "ERBA: " << slotCount << " slot da " << tuftsPerTile << " ciuffi, "
+                  << bladesPerTuft << " fili per ciuffo" << std::endl;
+    }
+
+    // Tile entro 'radius' da generare, tile oltre radius + tileSize da liberare
+    // (isteresi di una tile, così stare sul bordo non rigenera niente)
+    void Update(glm::vec3 const &cameraPosition) {
+        CPU_ZONE("GrassField::Update");
+        float release = radius + tileSize;
+        for (size_t i = 0; i < tiles.size();) {
+            if (DistanceXZ(tiles[i], cameraPosition) > release) {
+                freeSlots.push_back(tiles[i].slot);
+                tiles[i] = tiles.back();
+                tiles.pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        pending.clear();
+        float half = 0.5f * terrain->size;
+        int minX = std::max(0, (int)std::floor((cameraPosition.x - radius + half) / tileSize));
+        int maxX = std::min((int)(terrain->size / tileSize) - 1, (int)std::floor((cameraPosition.x + radius + half) / tileSize));
+        int minZ = std::max(0, (int)std::floor((cameraPosition.z - radius + half) / tileSize));
+        int maxZ = std::min((int)(terrain->size / tileSize) - 1, (int)std::floor((cameraPosition.z + radius + half) / tileSize));
+        for (int z = minZ; z <= maxZ; z++)
+            for (int x = minX; x <= maxX; x++) {
+                Tile tile;
+                tile.x = x;
+                tile.z = z;
+                if (DistanceXZ(tile, cameraPosition) > radius || Find(x, z) || freeSlots.empty())
+                    continue;
+                tile.slot = freeSlots.back();
+                freeSlots.pop_back();
+                pending.push_back(tile);
+            }
+        if (pending.empty())
+            return;
+
+        // Generazione in parallelo, upload sul thread GL
+        staging.resize(pending.size() * tuftsPerTile);
+        jobs.ParallelFor(pending.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                GenerateTile(pending[i], &staging[i * tuftsPerTile]);
+        });
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (size_t i = 0; i < pending.size(); i++) {
+            Tile const &tile = pending[i];
+            glBufferSubData(GL_ARRAY_BUFFER, (size_t)tile.slot * tuftsPerTile * sizeof(glm::vec4),
+                            tile.count * sizeof(glm::vec4), &staging[i * tuftsPerTile]);
+            renderStats.bufferBytes += tile.count * sizeof(glm::vec4);
+            tiles.push_back(tile);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Una draw istanziata per tile visibile, con le sole istanze che la densità può mostrare
+    void Render(ShaderLibrary &shaders, std::string const &family, glm::mat4 const &viewProjection,
+                glm::vec3 const &cameraPosition, float time, unsigned int features = 0) {
+        CPU_ZONE("GrassField::Render");
+        tilesDrawn = tuftsDrawn = 0;
+        unsigned int program = shaders.Get(family, features);
+        if (!program || tiles.empty())
+            return;
+
+        // Frazione per tile dal punto più vicino alla camera, poi scala comune per il budget
+        Frustum frustum(viewProjection);
+        visible.clear();
+        unsigned long requested = 0;
+        for (Tile const &tile : tiles) {
+            if (!frustum.Intersects(tile.bounds)) {
+                renderStats.culledObjects++;
+                continue;
+            }
+            float fraction = Fraction(glm::length(Nearest(tile.bounds, cameraPosition) - cameraPosition));
+            unsigned int count = (unsigned int)std::ceil(tile.count * fraction);
+            if (count == 0)
+                continue;
+            visible.push_back({ &tile, fraction });
+            requested += count;
+        }
+        densityScale = requested > instanceBudget ? (float)instanceBudget / requested : 1.0f;
+
+        glUseProgram(program);
+        glActiveTexture(GL_TEXTURE0 + TERRAIN_HEIGHT_UNIT);
+        glBindTexture(GL_TEXTURE_2D, terrain->HeightmapTexture());
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gradient);
+        glUniform1i(glGetUniformLocation(program, "texture_diffuse1"), 0);
+        glUniform4f(glGetUniformLocation(program, "terrainArea"), -0.5f * terrain->size, -0.5f * terrain->size,
+                    terrain->size, terrain->heightScale);
+        glUniform1f(glGetUniformLocation(program, "terrainBase"), terrain->baseHeight);
+        glUniform3f(glGetUniformLocation(program, "grassDensity"), nearDistance, farDistance, densityScale);
+        glUniform1f(glGetUniformLocation(program, "grassTime"), time);
+        int countLocation = glGetUniformLocation(program, "tileInstances");
+        renderStats.programBinds++;
+        renderStats.textureBinds += 2;
+        renderStats.uniformUploads += 6;
+
+        for (Visible const &entry : visible) {
+            Tile const &tile = *entry.tile;
+            unsigned int count = std::min(tile.count, (unsigned int)std::ceil(tile.count * entry.fraction * densityScale));
+            if (count == 0)
+                continue;
+            TuftMesh const &mesh = meshes[(tile.x * 7 + tile.z * 13) % meshes.size()];
+            glBindVertexArray(mesh.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4),
+                                  (void*)((size_t)tile.slot * tuftsPerTile * sizeof(glm::vec4)));
+            glUniform1f(countLocation, (float)tile.count);
+            glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, count);
+            tilesDrawn++;
+            tuftsDrawn += count;
+            renderStats.drawCalls++;
+            renderStats.instances += count;
+            renderStats.triangles += (uint64_t)mesh.indexCount / 3 * count;
+            renderStats.vertices += (uint64_t)mesh.vertexCount * count;
+            renderStats.vaoBinds++;
+            renderStats.uniformUploads++;
+        }
+        glBindVertexArray(0);
+    }
+
+    unsigned int Blades() const { return tuftsDrawn * bladesPerTuft; }
+
+private:
+    struct Tile {
+        int x = 0, z = 0;
+        unsigned int slot = 0;
+        unsigned int count = 0; // ciuffi generati (meno di tuftsPerTile dove il pendio li scarta)
+        AABB bounds;
+    };
+    struct Visible {
+        Tile const *tile;
+        float fraction;
+    };
+    struct TuftMesh {
+        unsigned int VAO = 0, VBO = 0, EBO = 0;
+        int indexCount = 0, vertexCount = 0;
+    };
+    struct BladeVertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoords; // v = 0 alla base, 1 in punta
+    };
+
+    Terrain const *terrain = nullptr;
+    unsigned int slotCount = 0;
+    unsigned int instanceBuffer = 0, gradient = 0;
+    std::vector<unsigned int> freeSlots;
+    std::vector<Tile> tiles, pending;
+    std::vector<glm::vec4> staging;
+    std::vector<Visible> visible;
+    std::vector<TuftMesh> meshes;
+
+    // xorshift come in Scatter: stessi ciuffi a ogni visita della tile
+    struct Random {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+        float Float() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    float Fraction(float distance) const {
+        return 1.0f - glm::smoothstep(nearDistance, farDistance, distance);
+    }
+
+    static glm::vec3 Nearest(AABB const &box, glm::vec3 const &p) { return glm::clamp(p, box.Min, box.Max); }
+
+    float DistanceXZ(Tile const &tile, glm::vec3 const &p) const {
+        float half = 0.5f * terrain->size;
+        glm::vec2 min(tile.x * tileSize - half, tile.z * tileSize - half);
+        glm::vec2 nearest = glm::clamp(glm::vec2(p.x, p.z), min, min + glm::vec2(tileSize));
+        return glm::length(nearest - glm::vec2(p.x, p.z));
+    }
+
+    bool Find(int x, int z) const {
+        for (Tile const &tile : tiles)
+            if (tile.x == x && tile.z == z)
+                return true;
+        for (Tile const &tile : pending)
+            if (tile.x == x && tile.z == z)
+                return true;
+        return false;
+    }
+
+    // Posizioni jittered su una griglia (copertura uniforme), poi rimescolate
+    // così i primi N ciuffi sono un sottoinsieme uniforme della tile
+    void GenerateTile(Tile &tile, glm::vec4 *out) const {
+        Random random(seed * 2654435761u ^ (uint32_t)tile.x * 2246822519u ^ (uint32_t)tile.z * 3266489917u);
+        float half = 0.5f * terrain->size;
+        unsigned int side = (unsigned int)std::ceil(std::sqrt((float)tuftsPerTile));
+        float cell = tileSize / side, minNormalY = std::cos(glm::radians(maxSlope));
+        tile.count = 0;
+        tile.bounds = AABB();
+        for (unsigned int i = 0; i < side * side && tile.count < tuftsPerTile; i++) {
+            float x = tile.x * tileSize - half + (i % side + random.Float()) * cell;
+            float z = tile.z * tileSize - half + (i / side + random.Float()) * cell;
+            float angle = random.Float() * 6.2831853f, scale = 0.7f + 0.6f * random.Float();
+            if (terrain->NormalAt(x, z).y < minNormalY)
+                continue;
+            out[tile.count++] = glm::vec4(x, z, angle, scale);
+            float y = terrain->HeightAt(x, z);
+            tile.bounds.Expand(glm::vec3(x - scale * 0.5f, y, z - scale * 0.5f));
+            tile.bounds.Expand(glm::vec3(x + scale * 0.5f, y + scale, z + scale * 0.5f));
+        }
+        for (unsigned int i = tile.count; i > 1; i--)
+            std::swap(out[i - 1], out[(unsigned int)(random.Float() * i)]);
+    }
+
+    // Ciuffo di fili curvi e rastremati attorno all'origine, alto circa 0.5 m
+    TuftMesh CreateTuft(uint32_t variantSeed) {
+        Random random(variantSeed);
+        const unsigned int segments = 4;
+        std::vector<BladeVertex> vertices;
+        std::vector<unsigned int> indices;
+        for (unsigned int b = 0; b < bladesPerTuft; b++) {
+            float angle = random.Float() * 6.2831853f, distance = 0.15f * random.Float();
+            glm::vec3 base(std::cos(angle) * distance, 0.0f, std::sin(angle) * distance);
+            float facing = random.Float() * 6.2831853f;
+            glm::vec3 side(std::cos(facing), 0.0f, std::sin(facing)), forward(-side.z, 0.0f, side.x);
+            float height = 0.35f + 0.35f * random.Float(), width = 0.03f + 0.03f * random.Float();
+            float bend = 0.1f + 0.25f * random.Float();
+            // Normale piegata verso l'alto: i fili sono a doppia faccia e la luce non cambia girandoci attorno
+            glm::vec3 normal = glm::normalize(forward * 0.5f + glm::vec3(0.0f, 1.0f, 0.0f));
+            unsigned int first = (unsigned int)vertices.size();
+            for (unsigned int s = 0; s <= segments; s++) {
+                float t = (float)s / segments;
+                glm::vec3 center = base + glm::vec3(0.0f, height * t, 0.0f) + forward * (bend * t * t);
+                float halfWidth = 0.5f * width * (1.0f - t);
+                vertices.push_back({ center - side * halfWidth, normal, glm::vec2(0.0f, t) });
+                if (s < segments)
+                    vertices.push_back({ center + side * halfWidth, normal, glm::vec2(1.0f, t) });
+            }
+            for (unsigned int s = 0; s < segments; s++) {
+                unsigned int i = first + 2 * s;
+                if (s + 1 < segments)
+                    indices.insert(indices.end(), { i, i + 1, i + 2, i + 1, i + 3, i + 2 });
+                else
+                    indices.insert(indices.end(), { i, i + 1, i + 2 }); // punta
+            }
+        }
+
+        TuftMesh mesh;
+        mesh.indexCount = (int)indices.size();
+        mesh.vertexCount = (int)vertices.size();
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        glGenBuffers(1, &mesh.EBO);
+        glBindVertexArray(mesh.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BladeVertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BladeVertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BladeVertex), (void*)offsetof(BladeVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BladeVertex), (void*)offsetof(BladeVertex, texCoords));
+        // Istanza (x, z, rotazione, scala): il puntatore lo sposta Render() sullo slot della tile
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+        glVertexAttribDivisor(4, 1);
+        glBindVertexArray(0);
+        gpuMemory.bufferBytes += vertices.size() * sizeof(BladeVertex) + indices.size() * sizeof(unsigned int);
+        return mesh;
+    }
+
+    // Colore lungo il filo (v): verde scuro alla base, giallo-verde in punta
+    unsigned int CreateGradient() {
+        const int texels = 32;
+        unsigned char pixels[texels * 4];
+        for (int i = 0; i < texels; i++) {
+            glm::vec3 color = glm::mix(glm::vec3(0.10f, 0.22f, 0.04f), glm::vec3(0.55f, 0.70f, 0.25f), (float)i / (texels - 1));
+            for (int c = 0; c < 3; c++)
+                pixels[i * 4 + c] = (unsigned char)(color[c] * 255.0f);
+            pixels[i * 4 + 3] = 255;
+        }
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, texels, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gpuMemory.textureBytes += texels * 4;
+        return texture;
+    }
+};
+
+#endif
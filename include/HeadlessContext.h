@@ -0,0 +1,146 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+// --- CONTESTO OPENGL SENZA FINESTRA ---
+// Per le macchine di render/CI senza display né GPU: un contesto 3.3 core
+// offscreen su Mesa (llvmpipe). Il backend si sceglie in CMake:
+//   HEADLESS_EGL    -> EGL surfaceless (EGL_MESA_platform_surfaceless), o pbuffer
+//   HEADLESS_OSMESA -> OSMesa, rendering puramente software
+// Il contesto non ha un framebuffer visibile: si disegna in un RenderTarget.
+
+#if defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#elif defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+class HeadlessContext {
+public:
+    // Nome del backend effettivamente usato (per i log dei benchmark)
+    const char *backend = "nessuno";
+
+    bool Create(int width, int height) {
+#if defined(HEADLESS_OSMESA)
+        const int attribs[] = {
+            OSMESA_FORMAT, OSMESA_RGBA,
+            OSMESA_DEPTH_BITS, 24,
+            OSMESA_STENCIL_BITS, 8,
+            OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+            OSMESA_CONTEXT_MAJOR_VERSION, 3,
+            OSMESA_CONTEXT_MINOR_VERSION, 3,
+            0
+        };
+        context = OSMesaCreateContextAttribs(attribs, NULL);
+        if (!context) {
+            std::cout << "ERRORE::HEADLESS:: OSMesaCreateContextAttribs fallita" << std::endl;
+            return false;
+        }
+        // OSMesa vuole comunque un buffer colore per il framebuffer di default
+        buffer.resize((size_t)width * height * 4);
+        if (!OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, width, height)) {
+            std::cout << "ERRORE::HEADLESS:: OSMesaMakeCurrent fallita" << std::endl;
+            return false;
+        }
+        backend = "OSMesa";
+        return true;
+#elif defined(HEADLESS_EGL)
+        // Display senza window system se Mesa lo offre, altrimenti quello di default
+        const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (clientExtensions && getPlatformDisplay && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+            std::cout << "ERRORE::HEADLESS:: nessun display EGL" << std::endl;
+            return false;
+        }
+
+        bool surfaceless = std::strstr(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") != NULL;
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint count = 0;
+        if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttribs, &config, 1, &count) || count == 0) {
+            std::cout << "ERRORE::HEADLESS:: nessuna configurazione EGL per OpenGL" << std::endl;
+            return false;
+        }
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT) {
+            std::cout << "ERRORE::HEADLESS:: eglCreateContext fallita (serve OpenGL 3.3 core)" << std::endl;
+            return false;
+        }
+
+        if (!surfaceless) {
+            const EGLint pbufferAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+            surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        }
+        if (!eglMakeCurrent(display, surface, surface, context)) {
+            std::cout << "ERRORE::HEADLESS:: eglMakeCurrent fallita" << std::endl;
+            return false;
+        }
+        backend = surfaceless ? "EGL surfaceless" : "EGL pbuffer";
+        return true;
+#else
+        (void)width; (void)height;
+        std::cout << "ERRORE::HEADLESS:: compilato senza backend (HEADLESS_EGL o HEADLESS_OSMESA)" << std::endl;
+        return false;
+#endif
+    }
+
+    // Da passare a gladLoadGLLoader e glExt.Load
+    static void *GetProcAddress(const char *name) {
+#if defined(HEADLESS_OSMESA)
+        return (void *)OSMesaGetProcAddress(name);
+#elif defined(HEADLESS_EGL)
+        return (void *)eglGetProcAddress(name);
+#else
+        (void)name;
+        return nullptr;
+#endif
+    }
+
+    void Destroy() {
+#if defined(HEADLESS_OSMESA)
+        if (context) OSMesaDestroyContext(context);
+        context = NULL;
+#elif defined(HEADLESS_EGL)
+        if (display != EGL_NO_DISPLAY) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+            if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+            eglTerminate(display);
+        }
+        display = EGL_NO_DISPLAY;
+#endif
+    }
+
+private:
+#if defined(HEADLESS_OSMESA)
+    OSMesaContext context = NULL;
+    std::vector<unsigned char> buffer;
+#elif defined(HEADLESS_EGL)
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+#endif
+};
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "CpuTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Contatore di completamento di un gruppo di job. Wait() lo attende aiutando
+// a eseguire altri job; le continuazioni registrate con JobSystem::After()
+// partono quando arriva a zero (dipendenze tra gruppi senza bloccare thread).
+class JobCounter {
+public:
+    bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> pending{ 0 };
+    std::mutex mutex;
+    std::vector<std::function<void()>> continuations;
+};
+
+// --- JOB SYSTEM CON WORK STEALING ---
+// Un deque per thread: chi lo possiede inserisce e preleva in coda (LIFO,
+// cache calda), i thread senza lavoro rubano dalla testa degli altri (FIFO,
+// i job più vecchi e di solito più grandi). Il thread che chiama Start() è il
+// thread 0 e partecipa quando attende; gli altri dormono su una condition
+// variable quando non trovano niente da fare. I deque sono protetti da un
+// mutex ciascuno: la contesa è bassa perché ognuno lavora quasi sempre sul suo.
+// Solo i worker aiutano con qualsiasi job mentre attendono: il thread 0 e i
+// thread esterni (rendering) eseguono soltanto i job del contatore atteso, così
+// un ParallelFor del frame non si ritrova a fare un caricamento dal disco.
+class JobSystem {
+public:
+    ~JobSystem() { Stop(); }
+
+    // threads = 0 -> uno per core. Si può richiamare per cambiare il numero (benchmark).
+    void Start(unsigned int threads = 0) {
+        Stop();
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        queues.clear();
+        for (unsigned int i = 0; i < threads; i++)
+            queues.push_back(std::make_unique<Queue>());
+        LocalIndex() = 0;
+        running.store(true);
+        for (unsigned int i = 1; i < threads; i++)
+            workers.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+
+    void Stop() {
+        if (!running.exchange(false))
+            return;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_all();
+        }
+        for (std::thread &t : workers)
+            t.join();
+        workers.clear();
+    }
+
+    unsigned int ThreadCount() const { return (unsigned int)std::max<size_t>(queues.size(), 1); }
+
+    // Accoda un job; 'counter' (opzionale) scende a zero quando tutti i suoi job sono finiti
+    void Run(std::function<void()> job, JobCounter *counter = nullptr) {
+        if (counter)
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        if (queues.empty()) {
+            // Sistema non avviato: esecuzione immediata, stesso risultato
+            job();
+            Finish(counter);
+            return;
+        }
+        Queue &queue = *queues[LocalQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back({ std::move(job), counter });
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        // Passare dal mutex evita di perdere la notifica a un worker che sta per dormire
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+
+    // Esegue 'job' (contato in 'counter') solo quando 'dependency' è completato
+    void After(JobCounter &dependency, std::function<void()> job, JobCounter *counter = nullptr) {
+        if (counter)
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        auto start = [this, job, counter]() {
+            Run(job, counter);
+            Finish(counter); // bilancia l'incremento fatto sopra
+        };
+        {
+            std::lock_guard<std::mutex> lock(dependency.mutex);
+            if (!dependency.Done()) {
+                dependency.continuations.push_back(start);
+                return;
+            }
+        }
+        start();
+    }
+
+    // Attende il contatore eseguendo nel frattempo altri job: qualsiasi per i
+    // worker, solo quelli di 'counter' per il thread 0 e i thread esterni
+    void Wait(JobCounter &counter) {
+        unsigned int self = LocalQueue();
+        bool worker = LocalIndex() > 0 && self > 0;
+        while (!counter.Done()) {
+            if (!(worker ? RunOne(self) : RunOneOf(counter, self)))
+                std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    // Divide [0, count) in blocchi da 'grain' e chiama body(begin, end) in parallelo.
+    // Ritorna quando tutti i blocchi sono finiti.
+    void ParallelFor(size_t count, size_t grain, std::function<void(size_t, size_t)> const &body) {
+        if (count == 0)
+            return;
+        grain = std::max<size_t>(grain, 1);
+        if (count <= grain || ThreadCount() == 1) {
+            body(0, count);
+            return;
+        }
+        JobCounter counter;
+        for (size_t begin = 0; begin < count; begin += grain) {
+            size_t end = std::min(count, begin + grain);
+            Run([&body, begin, end]() { body(begin, end); }, &counter);
+        }
+        Wait(counter);
+    }
+
+private:
+    struct Job {
+        std::function<void()> function;
+        JobCounter *counter = nullptr;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{ false };
+    std::atomic<int> queued{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    // Indice del thread nel sistema; -1 per thread esterni (accodano nel deque 0)
+    static int &LocalIndex() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    unsigned int LocalQueue() const {
+        int index = LocalIndex();
+        return index >= 0 && index < (int)queues.size() ? (unsigned int)index : 0;
+    }
+
+    bool Pop(unsigned int index, Job &job) {
+        Queue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    bool Steal(unsigned int index, Job &job) {
+        Queue &queue = *queues[index];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.jobs.empty())
+            return false;
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    // Un job dal proprio deque o, se vuoto, rubato a un altro thread
+    bool RunOne(unsigned int self) {
+        if (queued.load(std::memory_order_acquire) == 0)
+            return false;
+        Job job;
+        bool found = Pop(self, job);
+        for (unsigned int i = 1; !found && i < queues.size(); i++)
+            found = Steal((self + i) % queues.size(), job);
+        if (!found)
+            return false;
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        job.function();
+        Finish(job.counter);
+        return true;
+    }
+
+    // Un job di 'counter', cercato prima nel proprio deque (dalla coda) e poi
+    // negli altri: chi non è un worker non prende lavoro estraneo
+    bool RunOneOf(JobCounter &counter, unsigned int self) {
+        if (queued.load(std::memory_order_acquire) == 0)
+            return false;
+        Job job;
+        bool found = false;
+        for (unsigned int i = 0; !found && i < queues.size(); i++) {
+            Queue &queue = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            auto match = std::find_if(queue.jobs.rbegin(), queue.jobs.rend(),
+                                      [&counter](Job const &candidate) { return candidate.counter == &counter; });
+            if (match == queue.jobs.rend())
+                continue;
+            job = std::move(*match);
+            queue.jobs.erase(std::next(match).base());
+            found = true;
+        }
+        if (!found)
+            return false;
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        job.function();
+        Finish(job.counter);
+        return true;
+    }
+
+    // Il contatore si tocca solo sotto il suo mutex: Wait() lo riprende prima di
+    // ritornare, quindi chi lo ha sullo stack può distruggerlo subito dopo
+    void Finish(JobCounter *counter) {
+        if (!counter)
+            return;
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            continuations.swap(counter->continuations);
+        }
+        for (auto &continuation : continuations)
+            continuation();
+    }
+
+    void WorkerLoop(unsigned int index) {
+        LocalIndex() = (int)index;
+        CPU_TRACE_THREAD("job worker");
+        while (running.load(std::memory_order_acquire)) {
+            if (RunOne(index))
+                continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return !running.load() || queued.load() > 0; });
+        }
+    }
+};
+
+// Istanza globale, avviata in main (Start) prima del caricamento dei modelli
+inline JobSystem jobs;
+
+#endif
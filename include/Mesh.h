@@ -3,6 +3,9 @@
 
 #include <glad/glad.h> 
 #include <glm/glm.hpp>
+#include "ShaderLibrary.h"
+#include "RenderStats.h"
+#include "CpuTrace.h"
 #include <string>
 #include <vector>
 
@@ -10,12 +13,14 @@ struct Vertex {
     glm::vec3 Position;
     glm::vec3 Normal;
     glm::vec2 TexCoords;
+    glm::vec3 Tangent;
 };
 
 struct Texture {
     unsigned int id;
     std::string type;
     std::string path;
+    bool hasAlpha = false; // almeno un texel trasparente -> serve l'alpha test
 };
 
 class Mesh {
@@ -24,6 +29,7 @@ public:
     std::vector<unsigned int> indices;
     std::vector<Texture>      textures;
     unsigned int VAO;
+    unsigned int features = 0; // bit ShaderFeature richiesti da questa mesh
 
     Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures) {
         this->vertices = vertices;
@@ -33,7 +39,52 @@ public:
     }
 
     void Draw(unsigned int shaderProgram) {
-        // Lega le texture appropriate
+        BindTextures(shaderProgram);
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        renderStats.drawCalls++;
+        renderStats.instances++;
+        renderStats.triangles += indices.size() / 3;
+        renderStats.vertices += vertices.size();
+        renderStats.vaoBinds++;
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 'count' istanze con le matrici model lette da 'instanceBuffer' (mat4 per
+    // istanza, attributi 4..7) a partire dall'istanza 'first'. GL 3.3 non ha
+    // baseInstance: l'inizio si sposta con l'offset degli attributi.
+    void DrawInstanced(unsigned int shaderProgram, unsigned int instanceBuffer, size_t first, unsigned int count) {
+        BindTextures(shaderProgram);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (unsigned int column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(4 + column);
+            glVertexAttribPointer(4 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*)((first * 4 + column) * sizeof(glm::vec4)));
+            glVertexAttribDivisor(4 + column, 1);
+        }
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0, count);
+        // Il VAO è condiviso con Draw(): gli attributi di istanza non devono
+        // restare attivi puntando a un buffer che intanto può essere liberato
+        for (unsigned int column = 0; column < 4; column++) {
+            glDisableVertexAttribArray(4 + column);
+            glVertexAttribDivisor(4 + column, 0);
+        }
+        glBindVertexArray(0);
+        renderStats.drawCalls++;
+        renderStats.instances += count;
+        renderStats.triangles += indices.size() / 3 * count;
+        renderStats.vertices += vertices.size() * count;
+        renderStats.vaoBinds++;
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    unsigned int VBO, EBO;
+
+    // Lega le texture appropriate
+    void BindTextures(unsigned int shaderProgram) {
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
@@ -47,21 +98,26 @@ public:
                 number = std::to_string(diffuseNr++);
             else if(name == "texture_specular")
                 number = std::to_string(specularNr++); 
+            else if(name == "texture_normal")
+                number = std::to_string(normalNr++);
             
             glUniform1i(glGetUniformLocation(shaderProgram, (name + number).c_str()), i);
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
-        
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-        glActiveTexture(GL_TEXTURE0);
+        renderStats.textureBinds += textures.size();
+        renderStats.uniformUploads += textures.size();
     }
 
-private:
-    unsigned int VBO, EBO;
-
     void setupMesh() {
+        CPU_ZONE("Mesh::setupMesh");
+        // La variante di shader dipende dai materiali: foglie -> alpha test, bump -> normal map
+        for (unsigned int i = 0; i < textures.size(); i++) {
+            if (textures[i].type == "texture_diffuse" && textures[i].hasAlpha)
+                features |= SHADER_ALPHA_TEST;
+            if (textures[i].type == "texture_normal")
+                features |= SHADER_NORMAL_MAP;
+        }
+
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
@@ -72,6 +128,7 @@ private:
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        gpuMemory.bufferBytes += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int);
 
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
@@ -79,6 +136,8 @@ private:
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
 
         glBindVertexArray(0);
     }
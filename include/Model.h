@@ -10,19 +10,48 @@
 #include <assimp/postprocess.h>
 
 #include "Mesh.h"
+#include "Scene.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+#include "VirtualFileSystem.h"
+#include "AsyncIO.h"
+#include "TextureCompression.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <iostream>
 
-// Prototipo funzione intelligente
-unsigned int TextureFromFile(const char *path, const std::string &directory);
+// Immagine decodificata in RAM, in attesa dell'upload sul thread GL: pixel
+// RGBA8 in 'data' oppure blocchi già compressi per la GPU in 'compressed'
+struct DecodedImage {
+    std::string path;
+    unsigned char *data = nullptr;
+    std::unique_ptr<CompressedTexture> compressed;
+    int width = 0, height = 0;
+    bool hasAlpha = false;
+    bool fallback = false; // trovata accanto all'.obj invece che in Texture/
+
+    bool Valid() const { return data || compressed; }
+};
+
+// Prototipi funzioni intelligenti
+void TextureCandidates(const char *path, const std::string &directory, std::string candidates[2]);
+std::string MissingTexture(std::string const candidates[2], const std::string &directory);
+DecodedImage DecodeTexture(const char *path, const std::string &directory);
+DecodedImage DecodeTextureMemory(const unsigned char *data, size_t size, std::string const &path, bool fallback,
+                                 bool normalMap = false);
+unsigned int UploadTexture(DecodedImage &image);
+unsigned int TextureFromFile(const char *path, const std::string &directory, bool *hasAlpha = nullptr);
 
 class Model {
 public:
     std::vector<Texture> textures_loaded;	
     std::vector<Mesh>    meshes;
     std::string directory;
+    AABB bounds; // in coordinate del modello, per culling e ombre
 
     Model(std::string const &path) {
         loadModel(path);
@@ -33,9 +62,49 @@ public:
             meshes[i].Draw(shader);
     }
 
+    // Disegna ogni mesh con la variante della famiglia adatta al suo materiale.
+    // 'mask' filtra i bit delle mesh che la famiglia non usa (es. normal map nelle ombre).
+    // Restituisce il numero di draw call emesse.
+    unsigned int Draw(ShaderLibrary &shaders, std::string const &family, glm::mat4 const &model, unsigned int features = 0, unsigned int mask = ~0u) {
+        CPU_ZONE("Model::Draw");
+        unsigned int current = 0, draws = 0;
+        for(unsigned int i = 0; i < meshes.size(); i++) {
+            unsigned int program = shaders.Get(family, (meshes[i].features & mask) | features);
+            if (!program)
+                continue; // variante non ancora compilata: salta un frame
+            if (program != current) {
+                glUseProgram(program);
+                glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, &model[0][0]);
+                current = program;
+                renderStats.programBinds++;
+                renderStats.uniformUploads++;
+            }
+            meshes[i].Draw(program);
+            draws++;
+        }
+        return draws;
+    }
+
 private:
+    // Vertici e indici di una mesh convertiti da Assimp (solo CPU, senza GL)
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        AABB bounds;
+    };
+
+    // Una texture richiesta da un materiale
+    struct TextureRef {
+        std::string type;
+        std::string path;
+    };
+
     void loadModel(std::string const &path) {
+        CPU_ZONE("Model::loadModel");
         Assimp::Importer importer;
+        // Con un archivio montato .obj e .mtl arrivano dal VFS (l'importer si prende l'IOSystem)
+        if (vfs.Mounted())
+            importer.SetIOHandler(new VfsIOSystem());
         // Rimuoviamo FlipUVs perché spesso crea problemi con modelli scaricati
         const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
         
@@ -49,30 +118,136 @@ private:
         if (lastSlash != std::string::npos) directory = path.substr(0, lastSlash);
         else directory = "";
 
-        processNode(scene->mRootNode, scene);
-    }
+        std::vector<aiMesh*> sceneMeshes;
+        processNode(scene->mRootNode, scene, sceneMeshes);
+
+        // 1. Texture dei materiali, ciascuna una volta sola
+        std::vector<std::vector<TextureRef>> meshTextures(sceneMeshes.size());
+        std::vector<std::string> texturePaths;
+        std::vector<char> normalMaps; // compresse in BC5 (due canali)
+        for (size_t i = 0; i < sceneMeshes.size(); i++) {
+            meshTextures[i] = materialTextures(scene->mMaterials[sceneMeshes[i]->mMaterialIndex]);
+            for (TextureRef const &ref : meshTextures[i]) {
+                size_t index = std::find(texturePaths.begin(), texturePaths.end(), ref.path) - texturePaths.begin();
+                if (index == texturePaths.size()) {
+                    texturePaths.push_back(ref.path);
+                    normalMaps.push_back(false);
+                }
+                normalMaps[index] |= ref.type == "texture_normal";
+            }
+        }
+
+        // 2. Conversione delle mesh nei job mentre si leggono i file delle texture:
+        // quelli nell'archivio sono già in memoria, gli altri si leggono tutti in
+        // un lotto (AsyncIO.h) in buffer preallocati invece di un fopen/fread
+        // bloccante per immagine dentro stb_image
+        std::vector<DecodedImage> images(texturePaths.size());
+        std::vector<MeshData> meshData(sceneMeshes.size());
+        JobCounter loading;
+        for (size_t i = 0; i < meshData.size(); i++)
+            jobs.Run([&, i]() { meshData[i] = processMesh(sceneMeshes[i]); }, &loading);
+
+        std::vector<FileView> files(texturePaths.size());
+        std::vector<int> found(texturePaths.size(), -1); // candidato trovato (0 = Texture/, 1 = accanto all'.obj)
+        std::vector<std::string> candidates(texturePaths.size() * 2);
+        std::vector<ReadRequest> reads;
+        std::vector<size_t> readTexture;
+        for (size_t i = 0; i < texturePaths.size(); i++) {
+            TextureCandidates(texturePaths[i].c_str(), directory, &candidates[i * 2]);
+            for (int c = 0; c < 2 && found[i] < 0 && vfs.Mounted(); c++)
+                if ((files[i] = vfs.ReadPacked(candidates[i * 2 + c])))
+                    found[i] = c;
+            for (int c = 0; c < 2 && found[i] < 0; c++) {
+                long long size = FileSize(candidates[i * 2 + c]);
+                if (size < 0)
+                    continue;
+                found[i] = c;
+                files[i].owned = std::make_shared<std::vector<unsigned char>>((size_t)size);
+                ReadRequest read;
+                read.path = candidates[i * 2 + c];
+                read.size = (size_t)size;
+                read.buffer = files[i].owned->data();
+                read.priority = -(int)i; // nell'ordine del file, come gli upload
+                reads.push_back(read);
+                readTexture.push_back(i);
+            }
+        }
+        assetReader.ReadBatch(reads);
+        for (size_t r = 0; r < reads.size(); r++) {
+            FileView &file = files[readTexture[r]];
+            vfs.stats.diskReads++;
+            if (!reads[r].ok)
+                found[readTexture[r]] = -1;
+            file.data = file.owned->data();
+            file.size = reads[r].bytesRead;
+        }
 
-    void processNode(aiNode *node, const aiScene *scene) {
-        for(unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+        // 3. Decodifica delle immagini dai buffer, in parallelo
+        for (size_t i = 0; i < images.size(); i++)
+            jobs.Run([&, i]() {
+                if (found[i] >= 0)
+                    images[i] = DecodeTextureMemory(files[i].data, files[i].size, candidates[i * 2 + found[i]], found[i] == 1,
+                                                    normalMaps[i]);
+                else
+                    images[i].path = MissingTexture(&candidates[i * 2], directory);
+                files[i] = FileView(); // il file compresso non serve più
+            }, &loading);
+        jobs.Wait(loading);
+
+        // 4. Upload sul thread del contesto GL, nell'ordine del file
+        for (size_t i = 0; i < images.size(); i++) {
+            Texture texture;
+            texture.hasAlpha = images[i].hasAlpha;
+            texture.id = UploadTexture(images[i]);
+            texture.path = texturePaths[i];
+            textures_loaded.push_back(texture);
         }
+        for (size_t i = 0; i < meshData.size(); i++) {
+            std::vector<Texture> textures;
+            for (TextureRef const &ref : meshTextures[i]) {
+                size_t index = std::find(texturePaths.begin(), texturePaths.end(), ref.path) - texturePaths.begin();
+                Texture texture = textures_loaded[index];
+                texture.type = ref.type;
+                textures.push_back(texture);
+            }
+            if (meshData[i].bounds.Valid()) {
+                bounds.Expand(meshData[i].bounds.Min);
+                bounds.Expand(meshData[i].bounds.Max);
+            }
+            meshes.push_back(Mesh(std::move(meshData[i].vertices), std::move(meshData[i].indices), textures));
+        }
+    }
+
+    // Raccoglie le mesh nell'ordine della gerarchia dei nodi
+    void processNode(aiNode *node, const aiScene *scene, std::vector<aiMesh*> &out) {
+        CPU_ZONE("Model::processNode");
+        for(unsigned int i = 0; i < node->mNumMeshes; i++)
+            out.push_back(scene->mMeshes[node->mMeshes[i]]);
         for(unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, out);
         }
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene) {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture> textures;
+    // Eseguito dai job: legge solo la scena di Assimp e non tocca il modello
+    static MeshData processMesh(aiMesh *mesh) {
+        CPU_ZONE("Model::processMesh");
+        MeshData data;
+        std::vector<Vertex> &vertices = data.vertices;
+        std::vector<unsigned int> &indices = data.indices;
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve((size_t)mesh->mNumFaces * 3);
 
         // 1. Processa Vertici
         for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
             Vertex vertex;
             vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+            data.bounds.Expand(vertex.Position);
             if (mesh->HasNormals())
                 vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+            if (mesh->HasTangentsAndBitangents())
+                vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+            else
+                vertex.Tangent = glm::vec3(0.0f);
             if(mesh->mTextureCoords[0])
                 vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
             else
@@ -86,55 +261,52 @@ private:
             for(unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
+        return data;
+    }
 
-        // 3. Processa Materiali
-        if(mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-            
-            // Cerchiamo le texture Diffuse (Colore)
-            // NOTA: Alcuni modelli usano BASE_COLOR invece di DIFFUSE, proviamo entrambi
-            std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-            textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-            
-            // Se non trova diffuse, prova Base Color (standard moderno PBR)
-            if(diffuseMaps.empty()) {
-                std::vector<Texture> baseColorMaps = loadMaterialTextures(material, aiTextureType_BASE_COLOR, "texture_diffuse");
-                textures.insert(textures.end(), baseColorMaps.begin(), baseColorMaps.end());
-            }
-        }
-        
-        return Mesh(vertices, indices, textures);
+    // 3. Materiali: texture diffuse e normal map richieste da un materiale
+    static std::vector<TextureRef> materialTextures(aiMaterial *material) {
+        std::vector<TextureRef> refs;
+        // Cerchiamo le texture Diffuse (Colore)
+        // NOTA: Alcuni modelli usano BASE_COLOR invece di DIFFUSE, proviamo entrambi
+        if (!appendTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", refs))
+            appendTextures(material, aiTextureType_BASE_COLOR, "texture_diffuse", refs);
+
+        // Normal map: negli .obj la direttiva "bump" arriva come HEIGHT
+        if (!appendTextures(material, aiTextureType_NORMALS, "texture_normal", refs))
+            appendTextures(material, aiTextureType_HEIGHT, "texture_normal", refs);
+        return refs;
     }
 
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName) {
-        std::vector<Texture> textures;
+    static bool appendTextures(aiMaterial *mat, aiTextureType type, std::string const &typeName, std::vector<TextureRef> &refs) {
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
-            
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++) {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0) {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; 
-                    break;
-                }
-            }
-            if(!skip) {
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);
-            }
+            refs.push_back({ typeName, str.C_Str() });
         }
-        return textures;
+        return mat->GetTextureCount(type) > 0;
     }
 };
 
 // --- FUNZIONE INTELLIGENTE PER TROVARE I FILE ---
-unsigned int TextureFromFile(const char *path, const std::string &directory) {
+// Vero se almeno un pixel RGBA non è opaco
+bool ImageHasAlpha(const unsigned char *rgba, int width, int height) {
+    for (size_t i = 3; i < (size_t)width * height * 4; i += 4)
+        if (rgba[i] < 255)
+            return true;
+    return false;
+}
+
+// Vero se R, G e B coincidono (a meno dell'errore del JPEG) su tutta l'immagine
+bool ImageIsGrayscale(const unsigned char *rgba, int width, int height) {
+    for (size_t i = 0; i < (size_t)width * height * 4; i += 4)
+        if (std::abs(rgba[i] - rgba[i + 1]) > 2 || std::abs(rgba[i] - rgba[i + 2]) > 2)
+            return false;
+    return true;
+}
+
+// Percorsi in cui cercare la texture, in ordine: <directory>/Texture/, poi accanto all'.obj
+void TextureCandidates(const char *path, const std::string &directory, std::string candidates[2]) {
     std::string filename = std::string(path);
     
     // 1. PULIZIA: Rimuovi percorsi assoluti strani dal .mtl (es. C:\Users\Artist\...)
@@ -146,46 +318,145 @@ unsigned int TextureFromFile(const char *path, const std::string &directory) {
 
     // 2. COSTRUZIONE PERCORSO: Proviamo a cercare in assets/trees/Texture/
     // Assumiamo che 'directory' sia "assets/trees"
-    std::string finalPath = directory + "/Texture/" + filename;
+    candidates[0] = directory + "/Texture/" + filename;
+    candidates[1] = directory + "/" + filename;
+}
+
+// Messaggio per una texture che non è in nessuno dei due posti
+std::string MissingTexture(std::string const candidates[2], const std::string &directory) {
+    return candidates[1].substr(candidates[1].find_last_of('/') + 1) + " in " + directory + "/Texture/ o root.";
+}
+
+// Decodifica su CPU (sicura da qualunque thread) di un file già in memoria.
+// Con la cache delle texture attiva l'immagine si prende già compressa da lì;
+// se non c'è si decodifica, si comprime nel formato a blocchi adatto e si salva.
+DecodedImage DecodeTextureMemory(const unsigned char *data, size_t size, std::string const &path, bool fallback,
+                                 bool normalMap) {
+    DecodedImage image;
+    image.path = path;
+    image.fallback = fallback;
+    uint64_t key = 0;
+    if (textureCache.Enabled()) {
+        key = TextureCache::Key(data, size, normalMap);
+        image.compressed = std::make_unique<CompressedTexture>();
+        if (textureCache.Load(key, *image.compressed)) {
+            textureCache.stats.hits++;
+            image.width = image.compressed->width;
+            image.height = image.compressed->height;
+            image.hasAlpha = image.compressed->HasAlpha();
+            return image;
+        }
+        image.compressed.reset();
+    }
+    {
+        CPU_ZONE("stbi_load_from_memory");
+        int nrComponents;
+        // Forza 4 canali (RGBA) per evitare bug di allineamento
+        image.data = stbi_load_from_memory(data, (int)size, &image.width, &image.height, &nrComponents, 4);
+    }
+    if (!image.data)
+        return image;
+    image.hasAlpha = ImageHasAlpha(image.data, image.width, image.height);
+    TextureFormat format;
+    if (textureCache.Enabled()) {
+        bool grayscale = !normalMap && !image.hasAlpha && ImageIsGrayscale(image.data, image.width, image.height);
+        if (textureCache.Choose(image.hasAlpha, normalMap, grayscale, format)) {
+            auto start = std::chrono::high_resolution_clock::now();
+            image.compressed = std::make_unique<CompressedTexture>(
+                CompressTexture(image.data, image.width, image.height, format, normalMap));
+            textureCache.Store(key, *image.compressed);
+            textureCache.stats.encodeMicros += MicrosSince(start);
+            textureCache.stats.encoded++;
+            stbi_image_free(image.data);
+            image.data = nullptr;
+        }
+    }
+    return image;
+}
 
+// Decodifica su CPU (sicura da qualunque thread): cerca prima in <directory>/Texture/,
+// poi direttamente accanto all'.obj. Con un archivio montato i tentativi sono
+// ricerche nella sua tabella; il disco si prova solo se lì non c'è nessuno dei due.
+// Model carica le sue texture a lotti; questa serve per le texture singole.
+DecodedImage DecodeTexture(const char *path, const std::string &directory) {
+    DecodedImage image;
+    std::string candidates[2];
+    TextureCandidates(path, directory, candidates);
+    for (int i = 0; i < 2 && !image.Valid() && vfs.Mounted(); i++) {
+        FileView file = vfs.ReadPacked(candidates[i]);
+        if (file)
+            image = DecodeTextureMemory(file.data, file.size, candidates[i], i == 1);
+    }
+    for (int i = 0; i < 2 && !image.Valid(); i++) {
+        FileView file = vfs.Read(candidates[i]);
+        if (file)
+            image = DecodeTextureMemory(file.data, file.size, candidates[i], i == 1);
+    }
+    if (!image.Valid())
+        image.path = MissingTexture(candidates, directory);
+    return image;
+}
+
+// Upload sul thread del contesto GL; libera i pixel decodificati
+unsigned int UploadTexture(DecodedImage &image) {
+    CPU_ZONE("texture upload");
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    // Forza 4 canali (RGBA) per evitare bug di allineamento
-    unsigned char *data = stbi_load(finalPath.c_str(), &width, &height, &nrComponents, 4); 
-    
-    if (data) {
+    if (image.compressed) {
+        // Blocchi già pronti: ogni mip si copia così com'è, niente glGenerateMipmap
+        CompressedTexture const &texture = *image.compressed;
+        TextureFormatInfo const &info = FormatInfo(texture.format);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        int w = texture.width, h = texture.height;
+        for (size_t level = 0; level < texture.levels.size(); level++, w = std::max(1, w / 2), h = std::max(1, h / 2))
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, info.glFormat, w, h, 0,
+                                   (GLsizei)texture.levels[level].size(), texture.levels[level].data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+        if (texture.format == TEXTURE_BC4) {
+            // Scala di grigi in un canale solo: G e B ripetono R
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        }
+        gpuMemory.textureBytes += (long long)texture.Bytes();
+        textureCache.stats.gpuBytes += texture.Bytes();
+        textureCache.stats.rgbaBytes += (unsigned long long)image.width * image.height * 4 * 4 / 3;
+        textureCache.stats.formatCount[texture.format]++;
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        image.compressed.reset();
+        std::cout << (image.fallback ? "✅ CARICATA (FALLBACK, " : "✅ CARICATA TEXTURE (") << info.name << "): " << image.path << std::endl;
+    } else if (image.data) {
         GLenum format = GL_RGBA;
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        gpuMemory.textureBytes += (long long)image.width * image.height * 4 * 4 / 3; // + catena di mipmap
+        textureCache.stats.gpuBytes += (unsigned long long)image.width * image.height * 4 * 4 / 3;
+        textureCache.stats.rgbaBytes += (unsigned long long)image.width * image.height * 4 * 4 / 3;
+        textureCache.stats.uncompressed++;
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        stbi_image_free(data);
-        std::cout << "✅ CARICATA TEXTURE: " << finalPath << std::endl;
+        stbi_image_free(image.data);
+        image.data = nullptr;
+        std::cout << (image.fallback ? "✅ CARICATA (FALLBACK): " : "✅ CARICATA TEXTURE: ") << image.path << std::endl;
     } else {
-        // Fallback: Se fallisce, prova a cercare direttamente nella cartella dell'obj senza "Texture/"
-        std::string fallbackPath = directory + "/" + filename;
-        data = stbi_load(fallbackPath.c_str(), &width, &height, &nrComponents, 4);
-        
-        if(data) {
-             GLenum format = GL_RGBA;
-             glBindTexture(GL_TEXTURE_2D, textureID);
-             glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-             glGenerateMipmap(GL_TEXTURE_2D);
-             stbi_image_free(data);
-             std::cout << "✅ CARICATA (FALLBACK): " << fallbackPath << std::endl;
-        } else {
-            std::cout << "❌ FALLITA: Impossibile trovare " << filename << " in " << directory << "/Texture/ o root." << std::endl;
-            stbi_image_free(data);
-        }
+        std::cout << "❌ FALLITA: Impossibile trovare " << image.path << std::endl;
     }
-
     return textureID;
 }
+
+unsigned int TextureFromFile(const char *path, const std::string &directory, bool *hasAlpha) {
+    DecodedImage image = DecodeTexture(path, directory);
+    if (hasAlpha) *hasAlpha = image.hasAlpha;
+    return UploadTexture(image);
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,460 @@
+#ifndef PACK_FILE_H
+#define PACK_FILE_H
+
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Compressori opzionali, attivati da CMake se trova le librerie
+#ifdef PACK_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef PACK_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+// --- ARCHIVIO DEGLI ASSET ---
+// Un solo file con tutti gli asset, pensato per essere mappato in memoria:
+//   PackHeader
+//   dati delle entry, ciascuna allineata a 16 byte
+//   tabella hash di tableSize PackEntry (indirizzamento aperto, hash 0 = vuoto)
+//   nomi delle entry, concatenati (percorsi relativi con '/')
+// Una entry compressa è divisa in blocchi da PACK_BLOCK_SIZE byte originali,
+// compressi separatamente: prima la lista delle dimensioni compresse dei
+// blocchi (uint32), poi i blocchi. I blocchi si decomprimono in parallelo.
+// Le entry non compresse si leggono direttamente dalla mappa, senza copie.
+enum PackCompression : uint32_t { PACK_STORED = 0, PACK_LZ4 = 1, PACK_ZSTD = 2 };
+
+struct PackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t tableSize;   // potenza di due, almeno il doppio delle entry
+    uint64_t tableOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct PackEntry {
+    uint64_t hash;        // PackHash del nome; 0 = slot vuoto
+    uint64_t offset;      // dall'inizio del file
+    uint64_t storedSize;  // byte nel file (blocchi e loro dimensioni compresi)
+    uint64_t size;        // byte originali
+    uint32_t nameOffset, nameLength;
+    uint32_t compression; // PackCompression
+    uint32_t blockCount;  // 0 se non compressa
+};
+
+constexpr uint32_t PACK_MAGIC      = 0x4B415046; // "FPAK"
+constexpr uint32_t PACK_VERSION    = 1;
+constexpr uint64_t PACK_BLOCK_SIZE = 256 * 1024;
+
+// FNV-1a a 64 bit del percorso; mai 0, che segna gli slot vuoti
+inline uint64_t PackHash(const char *name, size_t length) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+inline const char *PackCompressionName(uint32_t compression) {
+    return compression == PACK_LZ4 ? "lz4" : compression == PACK_ZSTD ? "zstd" : "nessuna";
+}
+
+// Vero se questo eseguibile sa decomprimere (e comprimere) il formato
+inline bool PackCompressionSupported(uint32_t compression) {
+    switch (compression) {
+    case PACK_STORED: return true;
+#ifdef PACK_WITH_LZ4
+    case PACK_LZ4: return true;
+#endif
+#ifdef PACK_WITH_ZSTD
+    case PACK_ZSTD: return true;
+#endif
+    default: return false;
+    }
+}
+
+// Un blocco; restituisce i byte scritti in 'destination' (0 = errore)
+inline size_t PackDecompressBlock(uint32_t compression, const unsigned char *source, size_t sourceSize,
+                                  unsigned char *destination, size_t destinationSize) {
+#ifdef PACK_WITH_LZ4
+    if (compression == PACK_LZ4) {
+        int n = LZ4_decompress_safe((const char *)source, (char *)destination, (int)sourceSize, (int)destinationSize);
+        return n < 0 ? 0 : (size_t)n;
+    }
+#endif
+#ifdef PACK_WITH_ZSTD
+    if (compression == PACK_ZSTD) {
+        size_t n = ZSTD_decompress(destination, destinationSize, source, sourceSize);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+#endif
+    (void)compression; (void)source; (void)sourceSize; (void)destination; (void)destinationSize;
+    return 0;
+}
+
+// Un blocco compresso in coda a 'out'; falso se il formato non è disponibile
+inline bool PackCompressBlock(uint32_t compression, int level, const unsigned char *source, size_t size,
+                              std::vector<unsigned char> &out) {
+#ifdef PACK_WITH_LZ4
+    if (compression == PACK_LZ4) {
+        out.resize(LZ4_compressBound((int)size));
+        int n = LZ4_compress_default((const char *)source, (char *)out.data(), (int)size, (int)out.size());
+        out.resize(n > 0 ? (size_t)n : 0);
+        return n > 0;
+    }
+#endif
+#ifdef PACK_WITH_ZSTD
+    if (compression == PACK_ZSTD) {
+        out.resize(ZSTD_compressBound(size));
+        size_t n = ZSTD_compress(out.data(), out.size(), source, size, level);
+        out.resize(ZSTD_isError(n) ? 0 : n);
+        return !ZSTD_isError(n);
+    }
+#endif
+    (void)compression; (void)level; (void)source; (void)size; (void)out;
+    return false;
+}
+
+// --- LETTURA: ARCHIVIO MAPPATO IN MEMORIA ---
+// Dopo Open() è di sola lettura: Find/Data/Read si possono chiamare da
+// qualsiasi thread (i job di decodifica delle texture, Assimp...)
+class PackFile {
+public:
+    PackFile() = default;
+    PackFile(PackFile const &) = delete;
+    PackFile &operator=(PackFile const &) = delete;
+    ~PackFile() { Close(); }
+
+    bool Open(std::string const &path) {
+        Close();
+        if (!Map(path))
+            return false;
+        if (size < sizeof(PackHeader)) {
+            std::cout << "ERRORE::PACK::FORMATO " << path << std::endl;
+            Close();
+            return false;
+        }
+        header = (PackHeader const *)base;
+        bool valid = header->magic == PACK_MAGIC && header->version == PACK_VERSION &&
+                     header->tableSize && (header->tableSize & (header->tableSize - 1)) == 0 &&
+                     header->tableOffset + (uint64_t)header->tableSize * sizeof(PackEntry) <= size &&
+                     header->namesOffset + header->namesSize <= size;
+        if (!valid) {
+            std::cout << "ERRORE::PACK::FORMATO " << path << std::endl;
+            Close();
+            return false;
+        }
+        table = (PackEntry const *)(base + header->tableOffset);
+        names = (const char *)(base + header->namesOffset);
+        return true;
+    }
+
+    void Close() {
+        if (!base)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap((void *)base, size);
+#endif
+        base = nullptr;
+        size = 0;
+        header = nullptr;
+        table = nullptr;
+        names = nullptr;
+    }
+
+    bool IsOpen() const { return base != nullptr; }
+    uint32_t EntryCount() const { return header ? header->entryCount : 0; }
+    size_t MappedBytes() const { return size; }
+
+    // Entry del percorso (relativo, con '/'), nullptr se non c'è
+    PackEntry const *Find(const char *name, size_t length) const {
+        if (!table)
+            return nullptr;
+        uint64_t hash = PackHash(name, length);
+        uint32_t mask = header->tableSize - 1;
+        for (uint32_t probe = 0, i = (uint32_t)hash & mask; probe <= mask; probe++, i = (i + 1) & mask) {
+            PackEntry const &entry = table[i];
+            if (entry.hash == 0)
+                return nullptr;
+            if (entry.hash != hash || entry.nameLength != length ||
+                (uint64_t)entry.nameOffset + length > header->namesSize || std::memcmp(names + entry.nameOffset, name, length) != 0)
+                continue;
+            return Inside(entry) ? &entry : nullptr;
+        }
+        return nullptr;
+    }
+    PackEntry const *Find(std::string const &name) const { return Find(name.data(), name.size()); }
+
+    // Una entry che esce dal file è un archivio troncato: meglio non trovarla.
+    // Le non compresse si leggono direttamente (Data): 'size' deve stare nei
+    // byte salvati. Scritto senza somme, che con valori corrotti traboccano.
+    bool Inside(PackEntry const &entry) const {
+        return entry.offset <= size && entry.storedSize <= size - entry.offset &&
+               (entry.compression != PACK_STORED || entry.size <= entry.storedSize);
+    }
+
+    // Tutte le entry occupate della tabella (per strumenti e statistiche)
+    std::vector<PackEntry const *> Entries() const {
+        std::vector<PackEntry const *> entries;
+        for (uint32_t i = 0; table && i < header->tableSize; i++)
+            if (table[i].hash && Inside(table[i]))
+                entries.push_back(&table[i]);
+        return entries;
+    }
+
+    std::string Name(PackEntry const &entry) const { return std::string(names + entry.nameOffset, entry.nameLength); }
+
+    // Byte originali di una entry non compressa (da Find), direttamente dalla mappa
+    const unsigned char *Data(PackEntry const &entry) const {
+        return entry.compression == PACK_STORED ? base + entry.offset : nullptr;
+    }
+
+    // Decomprime una entry in 'out', un blocco per job
+    bool Read(PackEntry const &entry, std::vector<unsigned char> &out) const {
+        CPU_ZONE("PackFile::Read");
+        if (entry.compression == PACK_STORED) {
+            out.assign(base + entry.offset, base + entry.offset + entry.size);
+            return true;
+        }
+        if (!PackCompressionSupported(entry.compression)) {
+            std::cout << "ERRORE::PACK::COMPRESSIONE " << Name(entry) << ": " << PackCompressionName(entry.compression)
+                      << " non disponibile in questa build" << std::endl;
+            return false;
+        }
+        // La tabella delle dimensioni e i blocchi devono stare nei byte salvati
+        // dell'entry, e i blocchi devono coprire esattamente 'size'
+        uint64_t tableSize = (uint64_t)entry.blockCount * sizeof(uint32_t);
+        if (tableSize > entry.storedSize || entry.blockCount != (entry.size + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE) {
+            std::cout << "ERRORE::PACK::FORMATO " << Name(entry) << ": tabella dei blocchi non valida" << std::endl;
+            return false;
+        }
+        const uint32_t *blockSizes = (const uint32_t *)(base + entry.offset);
+        std::vector<uint64_t> blockOffsets(entry.blockCount + 1, entry.offset + tableSize);
+        for (uint32_t b = 0; b < entry.blockCount; b++)
+            blockOffsets[b + 1] = blockOffsets[b] + blockSizes[b];
+        if (blockOffsets.back() > entry.offset + entry.storedSize) {
+            std::cout << "ERRORE::PACK::FORMATO " << Name(entry) << ": blocchi oltre i byte salvati" << std::endl;
+            return false;
+        }
+        out.resize(entry.size);
+        std::atomic<bool> ok{ true };
+        jobs.ParallelFor(entry.blockCount, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++) {
+                size_t first = b * PACK_BLOCK_SIZE, length = std::min<size_t>(PACK_BLOCK_SIZE, entry.size - first);
+                size_t n = PackDecompressBlock(entry.compression, base + blockOffsets[b], blockSizes[b], out.data() + first, length);
+                if (n != length)
+                    ok.store(false);
+            }
+        });
+        if (!ok.load())
+            std::cout << "ERRORE::PACK::DECOMPRESSIONE " << Name(entry) << std::endl;
+        return ok.load();
+    }
+
+private:
+    const unsigned char *base = nullptr;
+    size_t size = 0;
+    PackHeader const *header = nullptr;
+    PackEntry const *table = nullptr;
+    const char *names = nullptr;
+
+    bool Map(std::string const &path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER length;
+        GetFileSizeEx(file, &length);
+        HANDLE mapping = length.QuadPart ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        base = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // la vista tiene viva la mappatura
+        size = base ? (size_t)length.QuadPart : 0;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void *mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // la mappa resta valida dopo la chiusura
+        if (mapped == MAP_FAILED)
+            return false;
+        base = (const unsigned char *)mapped;
+        size = (size_t)info.st_size;
+#endif
+        return base != nullptr;
+    }
+};
+
+// --- SCRITTURA (tools/pack_builder) ---
+class PackWriter {
+public:
+    struct Source {
+        std::string name; // chiave nell'archivio
+        std::string path; // file su disco
+    };
+
+    uint32_t compression = PACK_STORED;
+    int level = 3;                  // solo zstd
+    double minimumSaving = 0.05;    // si tiene la versione compressa se risparmia almeno il 5%
+
+    // Statistiche dell'ultimo Write()
+    uint64_t originalBytes = 0, storedBytes = 0;
+    uint32_t compressedEntries = 0;
+
+    void Add(std::string const &name, std::string const &path) { sources.push_back({ name, path }); }
+
+    bool Write(std::string const &path) {
+        CPU_ZONE("PackWriter::Write");
+        if (!PackCompressionSupported(compression)) {
+            std::cout << "ERRORE::PACK::COMPRESSIONE " << PackCompressionName(compression)
+                      << " non disponibile in questa build" << std::endl;
+            return false;
+        }
+        std::sort(sources.begin(), sources.end(), [](Source const &a, Source const &b) { return a.name < b.name; });
+
+        // Lettura e compressione in parallelo, una entry per job
+        std::vector<std::vector<unsigned char>> payloads(sources.size());
+        std::vector<PackEntry> entries(sources.size());
+        std::vector<char> failed(sources.size(), 0);
+        jobs.ParallelFor(sources.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                failed[i] = !Encode(sources[i].path, entries[i], payloads[i]);
+        });
+
+        std::string names;
+        uint32_t tableSize = 16;
+        while (tableSize < sources.size() * 2)
+            tableSize *= 2;
+        std::vector<PackEntry> table(tableSize);
+        std::memset(table.data(), 0, table.size() * sizeof(PackEntry));
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cout << "ERRORE::PACK::SCRITTURA " << path << std::endl;
+            return false;
+        }
+        PackHeader header = {};
+        file.write((const char *)&header, sizeof(header));
+        originalBytes = storedBytes = 0;
+        compressedEntries = 0;
+        uint32_t count = 0;
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (failed[i]) {
+                std::cout << "ERRORE::PACK::LETTURA " << sources[i].path << std::endl;
+                continue;
+            }
+            Align(file);
+            PackEntry entry = entries[i];
+            entry.offset = (uint64_t)file.tellp();
+            entry.nameOffset = (uint32_t)names.size();
+            entry.nameLength = (uint32_t)sources[i].name.size();
+            entry.hash = PackHash(sources[i].name.data(), sources[i].name.size());
+            names += sources[i].name;
+            file.write((const char *)payloads[i].data(), payloads[i].size());
+            originalBytes += entry.size;
+            storedBytes += entry.storedSize;
+            compressedEntries += entry.compression != PACK_STORED ? 1 : 0;
+
+            uint32_t slot = (uint32_t)entry.hash & (tableSize - 1);
+            while (table[slot].hash)
+                slot = (slot + 1) & (tableSize - 1);
+            table[slot] = entry;
+            count++;
+        }
+        Align(file);
+        header.magic = PACK_MAGIC;
+        header.version = PACK_VERSION;
+        header.entryCount = count;
+        header.tableSize = tableSize;
+        header.tableOffset = (uint64_t)file.tellp();
+        file.write((const char *)table.data(), table.size() * sizeof(PackEntry));
+        header.namesOffset = (uint64_t)file.tellp();
+        header.namesSize = names.size();
+        file.write(names.data(), names.size());
+        file.seekp(0);
+        file.write((const char *)&header, sizeof(header));
+        return (bool)file;
+    }
+
+private:
+    std::vector<Source> sources;
+
+    static void Align(std::ofstream &file) {
+        static const char zeros[16] = {};
+        std::streamoff position = file.tellp();
+        file.write(zeros, (16 - position % 16) % 16);
+    }
+
+    // Contenuto della entry come va scritto nel file, compresso se conviene
+    bool Encode(std::string const &path, PackEntry &entry, std::vector<unsigned char> &payload) const {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        std::vector<unsigned char> data((size_t)file.tellg());
+        file.seekg(0);
+        if (!file.read((char *)data.data(), data.size()))
+            return false;
+
+        entry = PackEntry();
+        entry.size = data.size();
+        if (compression != PACK_STORED && !data.empty()) {
+            uint32_t blocks = (uint32_t)((data.size() + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE);
+            std::vector<unsigned char> packed(blocks * sizeof(uint32_t)), block;
+            bool ok = true;
+            for (uint32_t b = 0; b < blocks && ok; b++) {
+                size_t first = b * PACK_BLOCK_SIZE, length = std::min<size_t>(PACK_BLOCK_SIZE, data.size() - first);
+                ok = PackCompressBlock(compression, level, data.data() + first, length, block);
+                uint32_t blockSize = (uint32_t)block.size();
+                std::memcpy(packed.data() + b * sizeof(uint32_t), &blockSize, sizeof(blockSize));
+                packed.insert(packed.end(), block.begin(), block.end());
+            }
+            if (ok && packed.size() < data.size() * (1.0 - minimumSaving)) {
+                entry.compression = compression;
+                entry.blockCount = blocks;
+                entry.storedSize = packed.size();
+                payload = std::move(packed);
+                return true;
+            }
+        }
+        entry.compression = PACK_STORED;
+        entry.storedSize = data.size();
+        payload = std::move(data);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// Contatori del lavoro inviato alla GPU nel frame corrente (tutti i pass,
+// ombre comprese). Si azzerano all'inizio del frame con Reset() e si leggono
+// direttamente dai campi, o si scrivono su file con RenderStatsLog.
+struct RenderStats {
+    uint64_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint64_t vertices = 0;       // vertici dei buffer disegnati
+    uint64_t instances = 0;      // 1 per draw non istanziato
+    uint64_t programBinds = 0;
+    uint64_t vaoBinds = 0;
+    uint64_t textureBinds = 0;
+    uint64_t uniformUploads = 0; // chiamate glUniform*
+    uint64_t bufferBytes = 0;    // byte caricati con glBufferSubData/glBufferData per frame
+    uint64_t culledObjects = 0;  // oggetti scartati dal culling (tutti i pass)
+
+    void Reset() { *this = RenderStats(); }
+
+    // Nome e campo di ogni contatore, nell'ordine delle colonne dei log
+    struct Field {
+        const char *name;
+        uint64_t RenderStats::*value;
+    };
+    static constexpr Field FIELDS[] = {
+        { "draw_calls", &RenderStats::drawCalls },
+        { "triangles", &RenderStats::triangles },
+        { "vertices", &RenderStats::vertices },
+        { "instances", &RenderStats::instances },
+        { "program_binds", &RenderStats::programBinds },
+        { "vao_binds", &RenderStats::vaoBinds },
+        { "texture_binds", &RenderStats::textureBinds },
+        { "uniform_uploads", &RenderStats::uniformUploads },
+        { "buffer_bytes", &RenderStats::bufferBytes },
+        { "culled_objects", &RenderStats::culledObjects },
+    };
+};
+
+// Istanza globale, aggiornata da Mesh::Draw, Model::Draw e dai pass del renderer
+inline RenderStats renderStats;
+
+// --- LOG DEI CONTATORI ---
+// Una riga ogni 'every' frame insieme ai tempi del frame, per correlare il
+// tempo con il carico. Il formato segue l'estensione: .json (array di oggetti)
+// oppure CSV con intestazione.
+class RenderStatsLog {
+public:
+    unsigned int every = 60;
+
+    bool Open(std::string const &path, unsigned int every) {
+        this->every = every ? every : 1;
+        json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            std::cout << "ERRORE::STATS:: impossibile scrivere " << path << std::endl;
+            return false;
+        }
+        if (json) {
+            std::fprintf(file, "[\n");
+        } else {
+            std::fprintf(file, "frame,cpu_ms,gpu_ms");
+            for (RenderStats::Field const &field : RenderStats::FIELDS)
+                std::fprintf(file, ",%s", field.name);
+            std::fprintf(file, "\n");
+        }
+        return true;
+    }
+
+    bool IsOpen() const { return file != nullptr; }
+
+    // Da chiamare a fine frame: scrive solo un frame ogni 'every'
+    void Write(unsigned long frame, double cpuMs, double gpuMs, RenderStats const &stats) {
+        if (!file || frame % every != 0)
+            return;
+        if (json) {
+            std::fprintf(file, "%s  { \"frame\": %lu, \"cpu_ms\": %.4f, \"gpu_ms\": %.4f", rows ? ",\n" : "", frame, cpuMs, gpuMs);
+            for (RenderStats::Field const &field : RenderStats::FIELDS)
+                std::fprintf(file, ", \"%s\": %" PRIu64, field.name, stats.*field.value);
+            std::fprintf(file, " }");
+        } else {
+            std::fprintf(file, "%lu,%.4f,%.4f", frame, cpuMs, gpuMs);
+            for (RenderStats::Field const &field : RenderStats::FIELDS)
+                std::fprintf(file, ",%" PRIu64, stats.*field.value);
+            std::fprintf(file, "\n");
+        }
+        rows++;
+    }
+
+    void Close() {
+        if (!file)
+            return;
+        if (json)
+            std::fprintf(file, "\n]\n");
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    ~RenderStatsLog() { Close(); }
+
+private:
+    FILE *file = nullptr;
+    bool json = false;
+    unsigned long rows = 0;
+};
+
+// Stima della memoria video allocata, aggiornata dove si creano le risorse.
+// È una contabilità nostra (i driver non la espongono in modo portabile):
+// texture con mipmap, vertex/index buffer e render target.
+struct GpuMemoryStats {
+    long long textureBytes = 0;
+    long long bufferBytes = 0;
+    long long targetBytes = 0;
+
+    long long Total() const { return textureBytes + bufferBytes + targetBytes; }
+};
+
+inline GpuMemoryStats gpuMemory;
+
+#endif
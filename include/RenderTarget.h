@@ -0,0 +1,100 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Immagini RGB 8 bit in formato PPM binario (P6): nessuna dipendenza esterna
+inline bool WritePPM(std::string const &path, std::vector<unsigned char> const &pixels, int width, int height) {
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERRORE::PPM:: impossibile scrivere " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::fwrite(pixels.data(), 1, pixels.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+inline bool ReadPPM(std::string const &path, std::vector<unsigned char> &pixels, int &width, int &height) {
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    int maxValue = 0;
+    bool ok = std::fscanf(file, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 && std::fgetc(file) != EOF;
+    if (ok) {
+        pixels.resize((size_t)width * height * 3);
+        ok = std::fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Framebuffer offscreen (colore RGBA8 + profondità/stencil) a risoluzione
+// arbitraria: destinazione del rendering headless e delle catture di immagini.
+// La profondità è DEPTH24_STENCIL8 come quella del G-buffer, così il blit del
+// percorso deferred funziona anche qui.
+class RenderTarget {
+public:
+    unsigned int FBO = 0;
+    int width = 0, height = 0;
+
+    bool Create(int width, int height) {
+        this->width = width;
+        this->height = height;
+        glGenFramebuffers(1, &FBO);
+        glGenRenderbuffers(1, &color);
+        glGenRenderbuffers(1, &depth);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        gpuMemory.targetBytes += (long long)width * height * 8;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (!complete)
+            std::cout << "ERRORE::RENDER_TARGET:: framebuffer incompleto" << std::endl;
+        return complete;
+    }
+
+    void Bind() {
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, width, height);
+    }
+
+    // Pixel RGB dall'alto verso il basso (OpenGL parte dal basso)
+    std::vector<unsigned char> ReadPixels() {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        size_t row = (size_t)width * 3;
+        std::vector<unsigned char> swap(row);
+        for (int y = 0; y < height / 2; y++) {
+            unsigned char *a = &pixels[y * row], *b = &pixels[(height - 1 - y) * row];
+            std::copy(a, a + row, swap.begin());
+            std::copy(b, b + row, a);
+            std::copy(swap.begin(), swap.end(), b);
+        }
+        return pixels;
+    }
+
+    bool SavePPM(std::string const &path) { return WritePPM(path, ReadPixels(), width, height); }
+
+private:
+    unsigned int color = 0, depth = 0;
+};
+
+#endif
@@ -0,0 +1,398 @@
+#ifndef SCATTER_H
+#define SCATTER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Model.h"
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "Terrain.h"
+#include "TransformKernel.h"
+#include "RenderStats.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Un tipo di oggetto da spargere sul terreno e le regole per piazzarlo
+struct ScatterLayer {
+    Model *model = nullptr;
+    const char *name = "";
+    float minDistance = 8.0f;       // distanza minima tra due istanze (raggio del Poisson disc)
+    float maxSlope = 30.0f;         // pendenza massima in gradi
+    float minHeight = -1e30f, maxHeight = 1e30f; // quote ammesse
+    float minScale = 0.8f, maxScale = 1.2f;
+    float alignToNormal = 0.0f;     // 0 = dritto (alberi), 1 = appoggiato al pendio (rocce)
+    float sink = 0.0f;              // metri sotto il terreno, per non lasciare la base sospesa
+    // Densità in [0, 1] nel punto (x, z): probabilità di tenere un punto del
+    // Poisson disc. Vuota = 1 ovunque.
+    std::function<float(float, float)> density;
+};
+
+// Istanze di un layer, ordinate per tile: le matrici della tile t stanno in
+// [tileStart[t], tileStart[t + 1]) e sono già il formato del buffer di istanze
+// (mat4 agli attributi 4..7 di forest.vert con INSTANCED)
+struct ScatterInstances {
+    Model *model = nullptr;
+    const char *name = "";
+    std::vector<glm::mat4> matrices;
+    std::vector<uint32_t> tileStart;
+    std::vector<AABB> tileBounds;
+    unsigned int instanceBuffer = 0;
+};
+
+// Rettangolo di tile [x0, x1) x [z0, z1) sulla griglia del terreno
+struct ScatterRegion {
+    int x0, z0, x1, z1;
+};
+
+// --- SCATTER PROCEDURALE SUL TERRENO ---
+// Poisson disc per tile quadrate, generate in parallelo sul job
+// system. Le tile si dividono in 4 fasi a scacchiera 2x2: nella stessa fase
+// nessuna tocca un'altra (nemmeno in diagonale), quindi girano insieme senza
+// lock, e ognuna rispetta la distanza minima dai punti delle vicine delle fasi
+// precedenti. Ogni tile ha il suo generatore, dal seed e dalle coordinate:
+// lo stesso seed dà le stesse istanze con qualsiasi numero di thread.
+// Una regione si genera da sola (celle dello streaming) con un bordo di 3 tile
+// delle fasi precedenti, e viene identica alla stessa zona del terreno intero.
+// Maschere di densità, pendenza e quota scartano punti dopo il campionamento,
+// così la distanza minima resta garantita.
+class Scatter {
+public:
+    float tileSize = 64.0f;         // lato delle tile (>= della minDistance più grande)
+    unsigned int attempts = 16;     // candidati per punto attivo (k di Bridson)
+    float drawDistance = 200.0f;    // oltre, le tile non si disegnano
+    std::vector<ScatterInstances> sets; // uno per layer
+
+    // Solo CPU: si può chiamare da qualsiasi thread, poi Upload() sul thread GL
+    void Generate(Terrain const &terrain, std::vector<ScatterLayer> const &layers, unsigned int seed) {
+        CPU_ZONE("Scatter::Generate");
+        int side = TilesPerSide(terrain);
+        sets = GenerateRegion(terrain, layers, seed, { 0, 0, side, side });
+    }
+
+    // Istanze dei layer nelle sole tile di 'region' (un insieme per layer)
+    std::vector<ScatterInstances> GenerateRegion(Terrain const &terrain, std::vector<ScatterLayer> const &layers,
+                                                 unsigned int seed, ScatterRegion const &region) const {
+        std::vector<ScatterInstances> out(layers.size());
+        for (size_t l = 0; l < layers.size(); l++)
+            GenerateLayer(terrain, layers[l], seed * 7919u + (unsigned int)l, region, out[l]);
+        return out;
+    }
+
+    int TilesPerSide(Terrain const &terrain) const { return std::max(1, (int)std::ceil(terrain.size / tileSize)); }
+
+    size_t InstanceCount() const {
+        size_t count = 0;
+        for (ScatterInstances const &set : sets)
+            count += set.matrices.size();
+        return count;
+    }
+
+    // Buffer statici delle istanze (uno per layer)
+    void Upload() {
+        for (ScatterInstances &set : sets)
+            if (!set.instanceBuffer)
+                set.instanceBuffer = CreateInstanceBuffer(set.matrices);
+    }
+
+    // Buffer statico di matrici di istanza (0 se non ce ne sono)
+    static unsigned int CreateInstanceBuffer(std::vector<glm::mat4> const &matrices) {
+        if (matrices.empty())
+            return 0;
+        unsigned int buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, matrices.size() * sizeof(glm::mat4), matrices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gpuMemory.bufferBytes += matrices.size() * sizeof(glm::mat4);
+        renderStats.bufferBytes += matrices.size() * sizeof(glm::mat4);
+        return buffer;
+    }
+
+    static void DeleteInstanceBuffer(unsigned int &buffer, size_t instances) {
+        if (!buffer)
+            return;
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        gpuMemory.bufferBytes -= instances * sizeof(glm::mat4);
+    }
+
+    unsigned int Render(ShaderLibrary &shaders, std::string const &family, glm::mat4 const &viewProjection,
+                        glm::vec3 const &cameraPosition, unsigned int features = 0, unsigned int mask = ~0u) {
+        Frustum frustum(viewProjection);
+        unsigned int draws = 0;
+        for (ScatterInstances const &set : sets)
+            draws += Render(set, set.instanceBuffer, shaders, family, frustum, cameraPosition, features, mask);
+        return draws;
+    }
+
+    // Tile nel frustum ed entro drawDistance; le tile consecutive visibili si
+    // uniscono in un solo draw istanziato per mesh. Restituisce le draw call.
+    // Il buffer è a parte perché le celle dello streaming lo tengono sul thread GL
+    unsigned int Render(ScatterInstances const &set, unsigned int instanceBuffer, ShaderLibrary &shaders,
+                        std::string const &family, Frustum const &frustum, glm::vec3 const &cameraPosition,
+                        unsigned int features = 0, unsigned int mask = ~0u) {
+        CPU_ZONE("Scatter::Render");
+        unsigned int draws = 0;
+        if (!instanceBuffer)
+            return 0;
+        runs.clear();
+        size_t tileCount = set.tileBounds.size();
+        for (size_t t = 0; t < tileCount; t++) {
+            AABB const &box = set.tileBounds[t];
+            glm::vec3 d = glm::max(glm::max(box.Min - cameraPosition, cameraPosition - box.Max), glm::vec3(0.0f));
+            bool visible = box.Valid() && glm::dot(d, d) < drawDistance * drawDistance && frustum.Intersects(box);
+            if (!visible) {
+                renderStats.culledObjects += set.tileStart[t + 1] - set.tileStart[t];
+                continue;
+            }
+            if (!runs.empty() && runs.back().end == set.tileStart[t])
+                runs.back().end = set.tileStart[t + 1];
+            else
+                runs.push_back({ set.tileStart[t], set.tileStart[t + 1] });
+        }
+        if (runs.empty())
+            return 0;
+        // Mesh all'esterno: un cambio di programma per mesh, non per tile
+        for (Mesh &mesh : set.model->meshes) {
+            unsigned int program = shaders.Get(family, (mesh.features & mask) | features | SHADER_INSTANCED);
+            if (!program)
+                continue;
+            glUseProgram(program);
+            renderStats.programBinds++;
+            for (Run const &run : runs) {
+                mesh.DrawInstanced(program, instanceBuffer, run.first, run.end - run.first);
+                draws++;
+            }
+        }
+        return draws;
+    }
+
+private:
+    // Intervallo [first, end) di istanze in tile consecutive visibili
+    struct Run {
+        uint32_t first, end;
+    };
+
+    std::vector<Run> runs;
+
+    // Punti generati nell'area di lavoro di una regione (tile in coordinate del terreno)
+    struct Area {
+        int x0, z0, columns, rows;
+        int tilesPerSide;
+        float origin;
+        std::vector<std::vector<glm::vec2>> points;
+
+        std::vector<glm::vec2> *Tile(int x, int z) {
+            if (x < x0 || z < z0 || x >= x0 + columns || z >= z0 + rows)
+                return nullptr;
+            return &points[(size_t)(z - z0) * columns + (x - x0)];
+        }
+    };
+
+    // Generatore deterministico per tile (xorshift, stesso risultato su ogni piattaforma)
+    struct Random {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+        uint32_t Next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+        float Float() { return (Next() >> 8) * (1.0f / 16777216.0f); } // [0, 1)
+    };
+
+    static uint32_t TileSeed(uint32_t seed, int x, int z) {
+        uint32_t h = seed * 2654435761u ^ (uint32_t)x * 2246822519u ^ (uint32_t)z * 3266489917u;
+        h ^= h >> 15;
+        h *= 668265263u;
+        return h ^ (h >> 13);
+    }
+
+    void GenerateLayer(Terrain const &terrain, ScatterLayer const &layer, uint32_t seed, ScatterRegion const &region,
+                       ScatterInstances &out) const {
+        CPU_ZONE("Scatter::GenerateLayer");
+        int regionColumns = region.x1 - region.x0;
+        size_t tileCount = (size_t)regionColumns * (region.z1 - region.z0);
+        float radius = std::min(layer.minDistance, tileSize);
+
+        // Una tile della fase p dipende dalle vicine delle fasi < p, quindi
+        // serve solo fino a 3 - p tile dalla regione
+        Area area;
+        area.tilesPerSide = TilesPerSide(terrain);
+        area.origin = -0.5f * terrain.size;
+        area.x0 = std::max(0, region.x0 - 3);
+        area.z0 = std::max(0, region.z0 - 3);
+        area.columns = std::min(area.tilesPerSide, region.x1 + 3) - area.x0;
+        area.rows = std::min(area.tilesPerSide, region.z1 + 3) - area.z0;
+        area.points.resize((size_t)area.columns * area.rows);
+
+        // Quattro fasi a scacchiera: le tile di una fase sono indipendenti
+        std::vector<glm::vec2> phaseTiles; // (x, z) come float per non aggiungere tipi interi
+        for (int phase = 0; phase < 4; phase++) {
+            phaseTiles.clear();
+            for (int z = area.z0 + ((area.z0 & 1) != (phase >> 1)); z < area.z0 + area.rows; z += 2)
+                for (int x = area.x0 + ((area.x0 & 1) != (phase & 1)); x < area.x0 + area.columns; x += 2) {
+                    int dx = std::max(std::max(region.x0 - x, x - (region.x1 - 1)), 0);
+                    int dz = std::max(std::max(region.z0 - z, z - (region.z1 - 1)), 0);
+                    if (std::max(dx, dz) <= 3 - phase)
+                        phaseTiles.push_back(glm::vec2((float)x, (float)z));
+                }
+            jobs.ParallelFor(phaseTiles.size(), 4, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    int tx = (int)phaseTiles[i].x, tz = (int)phaseTiles[i].y;
+                    SampleTile(area, tx, tz, radius, TileSeed(seed, tx, tz));
+                }
+            });
+        }
+
+        // Filtri e trasformazioni: ogni tile scrive le sue istanze in SoA
+        std::vector<TransformSoA> tiles(tileCount);
+        std::vector<std::vector<float>> radii(tileCount);
+        AABB local = layer.model ? layer.model->bounds : AABB();
+        float localRadius = local.Valid() ? glm::length(glm::max(glm::abs(local.Min), glm::abs(local.Max))) : 1.0f;
+        float minNormalY = std::cos(glm::radians(layer.maxSlope));
+        jobs.ParallelFor(tileCount, 16, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) {
+                int tx = region.x0 + (int)(t % regionColumns), tz = region.z0 + (int)(t / regionColumns);
+                Random random(TileSeed(seed ^ 0x5BD1E995u, tx, tz));
+                for (glm::vec2 const &p : *area.Tile(tx, tz)) {
+                    // Tre numeri per punto anche se scartato: i successivi non cambiano
+                    float keep = random.Float(), yaw = random.Float() * 6.2831853f, scale = random.Float();
+                    if (layer.density && keep >= layer.density(p.x, p.y))
+                        continue;
+                    float height = terrain.HeightAt(p.x, p.y);
+                    if (height < layer.minHeight || height > layer.maxHeight)
+                        continue;
+                    glm::vec3 normal = terrain.NormalAt(p.x, p.y);
+                    if (normal.y < minNormalY)
+                        continue;
+                    // Inclinazione verso la normale (una frazione alignToNormal), poi rotazione casuale attorno a Y
+                    glm::vec3 axis(normal.z, 0.0f, -normal.x); // cross(Y, normale)
+                    float tiltAngle = std::acos(glm::clamp(normal.y, -1.0f, 1.0f)) * layer.alignToNormal;
+                    glm::quat tilt = glm::dot(axis, axis) > 1e-8f ? glm::angleAxis(tiltAngle, glm::normalize(axis))
+                                                                 : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+                    glm::quat rotation = tilt * glm::angleAxis(yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+                    float s = glm::mix(layer.minScale, layer.maxScale, scale);
+                    tiles[t].Push(glm::vec3(p.x, height - layer.sink, p.y), rotation, glm::vec3(s));
+                    radii[t].push_back(localRadius * s);
+                }
+            }
+        });
+
+        // Concatenazione in ordine di tile, poi matrici e box in parallelo
+        out.model = layer.model;
+        out.name = layer.name;
+        out.tileStart.assign(tileCount + 1, 0);
+        for (size_t t = 0; t < tileCount; t++)
+            out.tileStart[t + 1] = out.tileStart[t] + (uint32_t)tiles[t].Size();
+        out.matrices.resize(out.tileStart[tileCount]);
+        out.tileBounds.assign(tileCount, AABB());
+        jobs.ParallelFor(tileCount, 16, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) {
+                TransformSoA const &trs = tiles[t];
+                glm::mat4 *matrices = out.matrices.data() + out.tileStart[t];
+                ComposeTransforms(trs, 0, trs.Size(), matrices);
+                for (size_t i = 0; i < trs.Size(); i++) {
+                    glm::vec3 center(matrices[i][3]);
+                    out.tileBounds[t].Expand(center - glm::vec3(radii[t][i]));
+                    out.tileBounds[t].Expand(center + glm::vec3(radii[t][i]));
+                }
+            }
+        });
+    }
+
+    // Bridson nella tile (tx, tz) con i punti già generati delle 8 vicine
+    void SampleTile(Area &area, int tx, int tz, float radius, uint32_t seed) const {
+        Random random(seed);
+        glm::vec2 tileMin(area.origin + tx * tileSize, area.origin + tz * tileSize);
+        glm::vec2 tileMax = tileMin + glm::vec2(tileSize);
+
+        // Griglia di accelerazione sulla tile allargata di 'radius' (celle di radius / sqrt(2): un punto per cella)
+        float cell = radius / std::sqrt(2.0f);
+        glm::vec2 gridMin = tileMin - glm::vec2(radius);
+        int cells = (int)std::ceil((tileSize + 2.0f * radius) / cell);
+        // Celle vuote lontanissime: il test di distanza non ha bisogno di casi speciali
+        std::vector<glm::vec2> grid((size_t)cells * cells, glm::vec2(1e30f));
+        std::vector<glm::vec2> candidates; // vicini in testa, poi i punti della tile
+        auto cellX = [&](glm::vec2 p) { return std::clamp((int)((p.x - gridMin.x) / cell), 0, cells - 1); };
+        auto cellZ = [&](glm::vec2 p) { return std::clamp((int)((p.y - gridMin.y) / cell), 0, cells - 1); };
+        auto insert = [&](glm::vec2 p) {
+            grid[(size_t)cellZ(p) * cells + cellX(p)] = p;
+            candidates.push_back(p);
+        };
+        // 5x5 celle attorno a p senza gli angoli (più lontani di 'radius')
+        auto isFree = [&](glm::vec2 p) {
+            int cx = cellX(p), cz = cellZ(p);
+            for (int z = std::max(0, cz - 2); z <= std::min(cells - 1, cz + 2); z++) {
+                int reach = (z == cz - 2 || z == cz + 2) ? 1 : 2;
+                for (int x = std::max(0, cx - reach); x <= std::min(cells - 1, cx + reach); x++) {
+                    glm::vec2 d = grid[(size_t)z * cells + x] - p;
+                    if (d.x * d.x + d.y * d.y < radius * radius)
+                        return false;
+                }
+            }
+            return true;
+        };
+
+        for (int dz = -1; dz <= 1; dz++)
+            for (int dx = -1; dx <= 1; dx++) {
+                std::vector<glm::vec2> const *neighbour = area.Tile(tx + dx, tz + dz);
+                if ((dx == 0 && dz == 0) || !neighbour)
+                    continue;
+                for (glm::vec2 const &p : *neighbour)
+                    if (p.x >= gridMin.x && p.y >= gridMin.y && p.x < tileMax.x + radius && p.y < tileMax.y + radius)
+                        insert(p);
+            }
+        size_t first = candidates.size();
+
+        std::vector<glm::vec2> directions(attempts);
+        for (unsigned int k = 0; k < attempts; k++)
+            directions[k] = glm::vec2(std::cos(6.2831853f * k / attempts), std::sin(6.2831853f * k / attempts));
+        std::vector<size_t> active;
+        // Nuovi semi casuali finché se ne trovano: le zone chiuse dai punti
+        // delle vicine non sono raggiungibili dal primo seme
+        for (unsigned int seedAttempt = 0; seedAttempt < attempts; seedAttempt++) {
+            glm::vec2 start = tileMin + glm::vec2(random.Float(), random.Float()) * tileSize;
+            if (!isFree(start))
+                continue;
+            insert(start);
+            active.push_back(candidates.size() - 1);
+            while (!active.empty()) {
+                size_t slot = random.Next() % active.size();
+                glm::vec2 center = candidates[active[slot]];
+                bool found = false;
+                // Variante di Roberts: candidati sul bordo dell'anello, a passi
+                // angolari regolari da un angolo casuale. Impacchetta di più e
+                // serve un terzo dei tentativi del campionamento nell'anello.
+                float turn = random.Float() * 6.2831853f;
+                float c = std::cos(turn), s = std::sin(turn);
+                for (unsigned int k = 0; k < attempts && !found; k++) {
+                    glm::vec2 direction = directions[k];
+                    glm::vec2 p = center + radius * 1.001f * glm::vec2(c * direction.x - s * direction.y, s * direction.x + c * direction.y);
+                    if (p.x < tileMin.x || p.y < tileMin.y || p.x >= tileMax.x || p.y >= tileMax.y || !isFree(p))
+                        continue;
+                    insert(p);
+                    active.push_back(candidates.size() - 1);
+                    found = true;
+                }
+                if (!found) {
+                    active[slot] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+        area.Tile(tx, tz)->assign(candidates.begin() + first, candidates.end());
+    }
+};
+
+#endif
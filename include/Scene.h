@@ -0,0 +1,110 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class Model;
+
+// Box allineato agli assi (coordinate locali del modello o mondo)
+struct AABB {
+    glm::vec3 Min = glm::vec3( 1e30f);
+    glm::vec3 Max = glm::vec3(-1e30f);
+
+    void Expand(glm::vec3 const &p) {
+        Min = glm::min(Min, p);
+        Max = glm::max(Max, p);
+    }
+
+    bool Valid() const { return Min.x <= Max.x; }
+    glm::vec3 Center() const { return (Min + Max) * 0.5f; }
+    glm::vec3 Extents() const { return (Max - Min) * 0.5f; }
+
+    // Box che contiene questo box trasformato da 'm' (metodo di Arvo)
+    AABB Transform(glm::mat4 const &m) const {
+        glm::vec3 center = glm::vec3(m * glm::vec4(Center(), 1.0f));
+        glm::vec3 extents = Extents();
+        glm::vec3 worldExtents(0.0f);
+        for (int row = 0; row < 3; row++)
+            worldExtents[row] = std::fabs(m[0][row]) * extents.x + std::fabs(m[1][row]) * extents.y + std::fabs(m[2][row]) * extents.z;
+        AABB out;
+        out.Min = center - worldExtents;
+        out.Max = center + worldExtents;
+        return out;
+    }
+};
+
+// Sei piani del frustum estratti da projection * view (metodo di Gribb/Hartmann);
+// normali verso l'interno, non normalizzate (basta il segno)
+struct Frustum {
+    glm::vec4 planes[6];
+
+    explicit Frustum(glm::mat4 const &viewProjection) {
+        for (int i = 0; i < 3; i++) {
+            glm::vec4 row(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+            planes[2 * i]     = w + row;
+            planes[2 * i + 1] = w - row;
+        }
+    }
+
+    // Falso solo se il box è interamente fuori da almeno un piano (conservativo)
+    bool Intersects(AABB const &box) const {
+        glm::vec3 center = box.Center(), extents = box.Extents();
+        for (glm::vec4 const &p : planes) {
+            float distance = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+            float radius = std::fabs(p.x) * extents.x + std::fabs(p.y) * extents.y + std::fabs(p.z) * extents.z;
+            if (distance + radius < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+// Un oggetto da piazzare nella scena (vedi EntityRegistry::Create)
+struct SceneObject {
+    Model    *model;
+    glm::mat4 transform;
+    bool      isStatic; // le ombre degli oggetti statici restano in cache
+    const char *name = ""; // etichetta per profiler e statistiche
+};
+
+// Riferimento a un'entità: l'indice si ricicla, la generazione no, quindi un
+// handle di un'entità distrutta non ne raggiunge per sbaglio una nuova
+struct Entity {
+    uint32_t index = ~0u;
+    uint32_t generation = 0;
+
+    bool operator==(Entity const &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(Entity const &other) const { return !(*this == other); }
+};
+
+enum EntityFlags : uint8_t {
+    ENTITY_STATIC = 1u << 0, // le ombre restano in cache (vedi ShadowMaps)
+};
+
+// Livello di dettaglio oltre la distanza massima: l'entità non si disegna
+const uint8_t LOD_HIDDEN = 0xFF;
+
+// --- COMPONENTI DELLA SCENA (SoA) ---
+// Un array per componente, tutti della stessa lunghezza e compatti: la riga i
+// è l'entità entities[i]. I sistemi scorrono solo gli array che leggono, in
+// ordine di memoria. È anche ciò che il render thread riceve nell'istantanea.
+struct SceneComponents {
+    std::vector<Entity>      entities;
+    std::vector<glm::mat4>   transforms;
+    std::vector<Model *>     models;
+    std::vector<AABB>        localBounds; // copia di Model::bounds: niente salti di puntatore
+    std::vector<AABB>        bounds;      // in coordinate mondo
+    std::vector<uint8_t>     lods;        // 0 = massimo dettaglio, LOD_HIDDEN = non disegnata
+    std::vector<uint8_t>     flags;       // EntityFlags
+    std::vector<const char *> names;
+
+    size_t Size() const { return entities.size(); }
+    bool IsStatic(size_t row) const { return flags[row] & ENTITY_STATIC; }
+};
+
+#endif
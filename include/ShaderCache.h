@@ -0,0 +1,239 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <glad/glad.h>
+#include "GLExtensions.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// --- CACHE SU DISCO DEI PROGRAMMI GLSL ---
+// Salva l'output di glGetProgramBinary in <directory>/<hash>.bin.
+// La chiave è l'hash di: sorgenti, #define, e stringa vendor/renderer/versione
+// del driver. Al riavvio si prova glProgramBinary; se il driver rifiuta il
+// binario (es. dopo un aggiornamento) si ricompila dai sorgenti e si riscrive.
+class ShaderCache {
+public:
+    std::string directory;
+
+    // Statistiche (per capire se la cache sta funzionando)
+    unsigned int hits     = 0;
+    unsigned int misses   = 0;
+    unsigned int rejected = 0;
+
+    ShaderCache(std::string const &directory) : directory(directory) {}
+
+    // 'defines' viene inserito subito dopo la riga #version di entrambi gli stage
+    unsigned int GetProgram(const char *vertexSource, const char *fragmentSource, std::string const &defines = "") {
+        std::string vs = InjectDefines(vertexSource, defines);
+        std::string fs = InjectDefines(fragmentSource, defines);
+
+        unsigned int program = Load(vs, fs);
+        if (program)
+            return program;
+
+        program = CompileProgram(vs, fs);
+        if (program)
+            Store(vs, fs, program);
+        return program;
+    }
+
+    // Prova a creare il programma dal binario in cache. Restituisce 0 se non c'è
+    // o se il driver lo rifiuta (in quel caso va ricompilato e salvato con Store).
+    unsigned int Load(std::string const &vs, std::string const &fs) {
+        if (!glExt.programBinary)
+            return 0;
+        uint64_t key = Key(vs, fs);
+        unsigned int program = glCreateProgram();
+        if (LoadBinary(PathFor(key), key, program)) {
+            hits++;
+            return program;
+        }
+        glDeleteProgram(program);
+        misses++;
+        return 0;
+    }
+
+    // Salva il binario di un programma già linkato con successo
+    void Store(std::string const &vs, std::string const &fs, unsigned int program) {
+        if (!glExt.programBinary)
+            return;
+        uint64_t key = Key(vs, fs);
+        StoreBinary(PathFor(key), key, program);
+    }
+
+    // Inserisce le #define dopo la prima riga (#version deve restare in cima)
+    static std::string InjectDefines(const char *source, std::string const &defines) {
+        std::string src(source);
+        if (defines.empty())
+            return src;
+        size_t eol = src.find('\n');
+        if (src.compare(0, 8, "#version") != 0 || eol == std::string::npos)
+            return defines + src;
+        return src.substr(0, eol + 1) + defines + src.substr(eol + 1);
+    }
+
+    // Compila e linka senza passare dalla cache. Restituisce 0 in caso di errore.
+    static unsigned int CompileProgram(std::string const &vs, std::string const &fs) {
+        unsigned int vertexShader = CompileStage(GL_VERTEX_SHADER, vs);
+        unsigned int fragmentShader = CompileStage(GL_FRAGMENT_SHADER, fs);
+        CheckStage(vertexShader);
+        CheckStage(fragmentShader);
+
+        unsigned int program = LinkProgram(vertexShader, fragmentShader);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        if (!CheckProgram(program)) {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    // Avvia il link senza interrogarne lo stato (che bloccherebbe fino alla fine)
+    static unsigned int LinkProgram(unsigned int vertexShader, unsigned int fragmentShader) {
+        unsigned int program = glCreateProgram();
+        // Va richiesto prima del link, altrimenti alcuni driver non lo rendono recuperabile
+        if (glExt.programBinary)
+            glExt.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+        return program;
+    }
+
+    // Come LinkProgram: lancia la compilazione e ritorna subito
+    static unsigned int CompileStage(GLenum type, std::string const &source) {
+        unsigned int shader = glCreateShader(type);
+        const char *src = source.c_str();
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    static bool CheckStage(unsigned int shader) {
+        int success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[1024];
+            glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+            std::cout << "ERRORE::SHADER::COMPILAZIONE\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+
+    static bool CheckProgram(unsigned int program) {
+        int success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[1024];
+            glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+            std::cout << "ERRORE::SHADER::LINK\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+
+    // FNV-1a a 64 bit: basta per distinguere le varianti, non serve crittografia
+    static uint64_t Hash(const void *data, size_t size, uint64_t h = 1469598103934665603ull) {
+        const unsigned char *p = (const unsigned char *)data;
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+private:
+    // Intestazione scritta davanti al binario, per scartare file corrotti o vecchi
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+    static constexpr uint32_t MAGIC   = 0x43505346; // "FSPC"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t Key(std::string const &vs, std::string const &fs) const {
+        std::string driver = glExt.DriverString();
+        uint64_t h = Hash(vs.data(), vs.size());
+        h = Hash("\x01", 1, h);
+        h = Hash(fs.data(), fs.size(), h);
+        h = Hash("\x02", 1, h);
+        return Hash(driver.data(), driver.size(), h);
+    }
+
+    std::string PathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+
+    bool LoadBinary(std::string const &path, uint64_t key, unsigned int program) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        Header header;
+        if (!file.read((char *)&header, sizeof(header)))
+            return false;
+        if (header.magic != MAGIC || header.version != VERSION || header.key != key || header.length == 0)
+            return false;
+
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), binary.size()))
+            return false;
+
+        glExt.ProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+        // Il driver può rifiutare il binario senza errori: conta solo il link status
+        int success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            rejected++;
+            std::cout << "⚠️ SHADER CACHE: binario rifiutato dal driver, ricompilo " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void StoreBinary(std::string const &path, uint64_t key, unsigned int program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glExt.GetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        // Scrive su un file temporaneo e poi rinomina: mai un .bin a metà
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+            Header header = { MAGIC, VERSION, key, (uint32_t)format, (uint32_t)written };
+            file.write((const char *)&header, sizeof(header));
+            file.write(binary.data(), written);
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+    }
+};
+
+#endif
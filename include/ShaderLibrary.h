@@ -0,0 +1,296 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "GLExtensions.h"
+#include "ShaderCache.h"
+#include "RenderStats.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Varianti di uno shader: ogni bit diventa una #define nel sorgente
+enum ShaderFeature : unsigned int {
+    SHADER_ALPHA_TEST = 1u << 0, // discard sui texel trasparenti (foglie)
+    SHADER_INSTANCED  = 1u << 1, // matrice model per-istanza (attributi 4..7)
+    SHADER_NORMAL_MAP = 1u << 2, // normale da texture_normal1 con TBN
+    SHADER_SHADOW_RECEIVER = 1u << 3, // campiona le cascaded shadow maps del sole
+    SHADER_FEATURE_COUNT = 4
+};
+
+inline const char *ShaderFeatureDefine(unsigned int bit) {
+    switch (bit) {
+        case SHADER_ALPHA_TEST: return "ALPHA_TEST";
+        case SHADER_INSTANCED:  return "INSTANCED";
+        case SHADER_NORMAL_MAP: return "NORMAL_MAP";
+        case SHADER_SHADOW_RECEIVER: return "SHADOW_RECEIVER";
+    }
+    return nullptr;
+}
+
+// Binding fisso del blocco uniform "Camera" (view, projection, viewPos)
+const unsigned int CAMERA_UBO_BINDING = 0;
+
+// Uniform buffer del blocco "Camera" di common.glsl: si aggiorna una volta per
+// frame invece di ricaricare view/projection in ogni programma
+class CameraBuffer {
+public:
+    unsigned int UBO = 0;
+
+    void Create() {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4) + sizeof(glm::vec4), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, UBO);
+    }
+
+    void Update(glm::mat4 const &view, glm::mat4 const &projection, glm::vec3 const &viewPos) {
+        glm::vec4 pos(viewPos, 1.0f);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &view[0][0]);
+        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &projection[0][0]);
+        glBufferSubData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), sizeof(glm::vec4), &pos[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        renderStats.bufferBytes += 2 * sizeof(glm::mat4) + sizeof(glm::vec4);
+    }
+};
+
+// --- LIBRERIA DI SHADER CON PERMUTAZIONI ---
+// I sorgenti stanno in file (con supporto a #include "file"), le varianti si
+// generano a richiesta combinando i bit di ShaderFeature. La compilazione è
+// asincrona: Request() lancia compile+link e ritorna subito, Update() (una
+// volta per frame) raccoglie i programmi finiti. Con KHR_parallel_shader_compile
+// il driver usa più thread e lo stato si interroga senza bloccare; senza, si
+// finalizzano pochi programmi per frame. Get() non aspetta mai: se la variante
+// non è ancora pronta restituisce quella "più vicina" già disponibile.
+class ShaderLibrary {
+public:
+    std::string directory;
+
+    // Senza KHR_parallel_shader_compile: quanti programmi finalizzare per frame
+    unsigned int finalizeBudget = 2;
+
+    ShaderLibrary(std::string const &directory, ShaderCache &cache) : directory(directory), cache(cache) {
+        // 0xFFFFFFFF = numero di thread scelto dal driver
+        if (glExt.parallelShaderCompile)
+            glExt.MaxShaderCompilerThreads(0xFFFFFFFFu);
+        BindUniformBlock("Camera", CAMERA_UBO_BINDING);
+    }
+
+    // Binding fissi applicati a ogni programma appena pronto (prima di Request)
+    void BindUniformBlock(std::string const &block, unsigned int binding) { uniformBlocks[block] = binding; }
+    void BindSampler(std::string const &sampler, unsigned int unit) { samplers[sampler] = unit; }
+
+    // Registra una famiglia di shader (es. "forest" -> forest.vert + forest.frag)
+    void Register(std::string const &name, std::string const &vertexFile, std::string const &fragmentFile) {
+        Family family;
+        family.vertexSource = LoadSource(vertexFile);
+        family.fragmentSource = LoadSource(fragmentFile);
+        families[name] = family;
+    }
+
+    // Chiede una variante: se non esiste ancora ne avvia la compilazione
+    void Request(std::string const &name, unsigned int features) {
+        Key key(name, features);
+        if (programs.count(key) || !families.count(name))
+            return;
+
+        Family &family = families[name];
+        std::string defines = DefinesFor(features);
+        Variant variant;
+        variant.vs = ShaderCache::InjectDefines(family.vertexSource.c_str(), defines);
+        variant.fs = ShaderCache::InjectDefines(family.fragmentSource.c_str(), defines);
+
+        // Avvio a caldo: il binario in cache è già pronto
+        variant.program = cache.Load(variant.vs, variant.fs);
+        if (variant.program) {
+            SetupProgram(variant.program);
+            variant.state = READY;
+            programs[key] = variant;
+            return;
+        }
+
+        variant.vertexShader = ShaderCache::CompileStage(GL_VERTEX_SHADER, variant.vs);
+        variant.fragmentShader = ShaderCache::CompileStage(GL_FRAGMENT_SHADER, variant.fs);
+        variant.program = ShaderCache::LinkProgram(variant.vertexShader, variant.fragmentShader);
+        variant.state = PENDING;
+        programs[key] = variant;
+        pending.push_back(key);
+    }
+
+    // Chiede tutte le combinazioni dei bit in 'mask' (mask = 0 -> solo la base)
+    void RequestAll(std::string const &name, unsigned int mask) {
+        for (unsigned int features = 0; features <= mask; features++)
+            if ((features & ~mask) == 0)
+                Request(name, features);
+    }
+
+    // Da chiamare una volta per frame: raccoglie le varianti finite
+    void Update() {
+        unsigned int budget = finalizeBudget;
+        for (size_t i = 0; i < pending.size();) {
+            Variant &variant = programs[pending[i]];
+            if (glExt.parallelShaderCompile) {
+                GLint done = GL_FALSE;
+                glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &done);
+                if (!done) { i++; continue; }
+            } else {
+                // Senza estensione interrogare lo stato blocca: solo pochi per frame
+                if (budget == 0) break;
+                budget--;
+            }
+            Finalize(variant);
+            pending.erase(pending.begin() + i);
+        }
+    }
+
+    // Blocca finché tutte le varianti richieste sono pronte (benchmark, headless)
+    void WaitAll() {
+        for (Key const &key : pending)
+            Finalize(programs[key]);
+        pending.clear();
+    }
+
+    bool Idle() const { return pending.empty(); }
+
+    // Richieste servite con una variante di ripiego (o con 0) perché quella chiesta
+    // è ancora in compilazione: chi mette in cache il risultato (ombre statiche)
+    // confronta il valore prima e dopo il disegno.
+    unsigned long long fallbacks = 0;
+
+    // Programma per la variante richiesta; se non è pronta rinuncia alle feature
+    // solo "estetiche" (vedi DROPPABLE) finché ne trova una pronta. 0 se nessuna lo è.
+    unsigned int Get(std::string const &name, unsigned int features) {
+        Request(name, features);
+        unsigned int program = Ready(name, features);
+        auto requested = programs.find(Key(name, features));
+        if (!program && requested != programs.end() && requested->second.state == PENDING)
+            fallbacks++;
+        for (unsigned int i = 0; !program && i < sizeof(DROPPABLE) / sizeof(DROPPABLE[0]); i++) {
+            features &= ~DROPPABLE[i];
+            program = Ready(name, features);
+        }
+        return program;
+    }
+
+    // Legge un file di shader espandendo le direttive #include "file"
+    std::string LoadSource(std::string const &file) {
+        std::set<std::string> included;
+        return Expand(file, included);
+    }
+
+    static std::string DefinesFor(unsigned int features) {
+        std::string defines;
+        for (unsigned int i = 0; i < SHADER_FEATURE_COUNT; i++)
+            if (features & (1u << i))
+                defines += std::string("#define ") + ShaderFeatureDefine(1u << i) + "\n";
+        return defines;
+    }
+
+private:
+    enum State { PENDING, READY, FAILED };
+
+    struct Family {
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+
+    struct Variant {
+        std::string vs, fs;
+        unsigned int vertexShader = 0, fragmentShader = 0;
+        unsigned int program = 0;
+        State state = PENDING;
+    };
+
+    typedef std::pair<std::string, unsigned int> Key;
+
+    // Feature a cui si può rinunciare per qualche frame, in ordine. INSTANCED
+    // no: cambia l'input del vertex shader e il disegno sarebbe sbagliato.
+    static constexpr unsigned int DROPPABLE[] = { SHADER_SHADOW_RECEIVER, SHADER_NORMAL_MAP, SHADER_ALPHA_TEST };
+
+    ShaderCache &cache;
+    std::map<std::string, unsigned int> uniformBlocks;
+    std::map<std::string, unsigned int> samplers;
+    std::map<std::string, Family> families;
+    std::map<Key, Variant> programs;
+    std::vector<Key> pending;
+
+    unsigned int Ready(std::string const &name, unsigned int features) const {
+        auto it = programs.find(Key(name, features));
+        return it != programs.end() && it->second.state == READY ? it->second.program : 0;
+    }
+
+    void Finalize(Variant &variant) {
+        ShaderCache::CheckStage(variant.vertexShader);
+        ShaderCache::CheckStage(variant.fragmentShader);
+        glDeleteShader(variant.vertexShader);
+        glDeleteShader(variant.fragmentShader);
+        variant.vertexShader = variant.fragmentShader = 0;
+
+        if (ShaderCache::CheckProgram(variant.program)) {
+            cache.Store(variant.vs, variant.fs, variant.program);
+            SetupProgram(variant.program);
+            variant.state = READY;
+        } else {
+            glDeleteProgram(variant.program);
+            variant.program = 0;
+            variant.state = FAILED;
+        }
+        // I sorgenti servivano solo per la chiave della cache
+        variant.vs.clear();
+        variant.fs.clear();
+    }
+
+    // Impostazioni che non dipendono dal draw: blocchi uniform e unità dei sampler fissi
+    void SetupProgram(unsigned int program) {
+        for (auto const &it : uniformBlocks) {
+            unsigned int index = glGetUniformBlockIndex(program, it.first.c_str());
+            if (index != GL_INVALID_INDEX)
+                glUniformBlockBinding(program, index, it.second);
+        }
+        glUseProgram(program);
+        for (auto const &it : samplers) {
+            int location = glGetUniformLocation(program, it.first.c_str());
+            if (location >= 0)
+                glUniform1i(location, it.second);
+        }
+        glUseProgram(0);
+    }
+
+    std::string Expand(std::string const &file, std::set<std::string> &included) {
+        // Ogni file viene incluso una sola volta (niente include guard nei .glsl)
+        if (!included.insert(file).second)
+            return "";
+
+        std::ifstream in(directory + "/" + file);
+        if (!in) {
+            std::cout << "ERRORE::SHADER::FILE non trovato: " << directory << "/" << file << std::endl;
+            return "";
+        }
+
+        std::stringstream out;
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+                size_t open = line.find('"', start);
+                size_t close = line.find('"', open + 1);
+                if (open != std::string::npos && close != std::string::npos) {
+                    out << Expand(line.substr(open + 1, close - open - 1), included);
+                    continue;
+                }
+            }
+            out << line << "\n";
+        }
+        return out.str();
+    }
+};
+
+#endif
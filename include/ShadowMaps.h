@@ -0,0 +1,330 @@
+#ifndef SHADOW_MAPS_H
+#define SHADOW_MAPS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Model.h"
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "CpuTrace.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+const unsigned int SHADOW_UBO_BINDING = 2;
+const unsigned int SHADOW_MAP_UNIT    = 11;
+
+// Contatori del pass ombre, separati da quelli del pass principale
+struct ShadowStats {
+    unsigned int drawCalls       = 0; // mesh disegnate in tutte le cascate
+    unsigned int casters         = 0; // oggetti passati al culling di una cascata
+    unsigned int culled          = 0; // oggetti scartati dal culling per cascata
+    unsigned int cascadesRendered = 0; // cascate statiche ridisegnate (miss della cache)
+    unsigned int cascadesCached  = 0; // cascate riusate dalla cache
+    double cpuMs = 0.0;
+    double gpuMs = 0.0; // dal timer query del frame precedente
+};
+
+// --- CASCADED SHADOW MAPS PER IL SOLE ---
+// Il frustum di vista (fino a shadowDistance) è diviso in CASCADES fette con lo
+// schema "pratico" (mix logaritmico/lineare). Ogni fetta è racchiusa in una sfera,
+// così la dimensione della proiezione ortografica non cambia ruotando la camera,
+// e il centro è agganciato alla griglia dei texel: niente sfarfallio muovendosi.
+//
+// Cache: ogni cascata viene disegnata con un margine attorno alla sfera. Finché la
+// sfera del frame corrente sta dentro l'area già disegnata si riusano mappa e
+// matrice, e la geometria statica non viene ridisegnata. Gli oggetti dinamici si
+// aggiungono ogni frame sopra una copia della mappa statica.
+class ShadowMaps {
+public:
+    static const int CASCADES = 4;
+
+    unsigned int resolution = 2048;
+    float shadowDistance = 150.0f;
+    float splitLambda    = 0.75f; // 1 = logaritmico, 0 = lineare
+    float cacheMargin    = 0.15f; // area extra disegnata attorno alla sfera della cascata
+    float casterDistance = 60.0f; // quanto indietro verso il sole cercare occlusori
+    float depthBias      = 0.0015f;
+
+    ShadowStats stats;
+
+    void Create() {
+        staticMap = CreateArray();
+        finalMap  = CreateArray();
+        glGenFramebuffers(1, &FBO);
+        glGenFramebuffers(1, &readFBO);
+        // Solo profondità: senza glReadBuffer(GL_NONE) in GL 3.3 il framebuffer
+        // di lettura può risultare incompleto e il blit di CopyLayer fallire in silenzio
+        GLint framebuffer;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, readFBO);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticMap, 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERRORE::SHADOW:: framebuffer di lettura delle ombre incompleto" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenQueries(2, queries);
+
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowBlock), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, SHADOW_UBO_BINDING, UBO);
+    }
+
+    // La geometria statica è cambiata: tutte le cascate vanno ridisegnate
+    void MarkDirty() {
+        for (int i = 0; i < CASCADES; i++)
+            cascades[i].valid = false;
+    }
+
+    // Aggiorna le cascate per la camera corrente e ridisegna solo ciò che serve.
+    // Usa cameraBuffer per le matrici del pass (viene lasciato con quelle della luce).
+    void Render(SceneComponents const &scene, ShaderLibrary &shaders, CameraBuffer &cameraBuffer,
+                glm::mat4 const &view, float fovY, float aspect, float zNear, glm::vec3 const &lightDirection) {
+        CPU_ZONE("ShadowMaps::Render");
+        auto start = std::chrono::high_resolution_clock::now();
+        stats = ShadowStats { 0, 0, 0, 0, 0, 0.0, ReadGpuTime() };
+
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame & 1]);
+
+        GLint viewport[4], framebuffer;
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glViewport(0, 0, resolution, resolution);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+        glm::mat4 lightRotation = LightRotation(lightDirection);
+        if (lightDirection != this->lightDirection) {
+            this->lightDirection = lightDirection;
+            MarkDirty(); // ruotando il sole tutto il contenuto è da rifare
+        }
+
+        bool hasDynamic = false;
+        for (uint8_t flags : scene.flags)
+            hasDynamic |= !(flags & ENTITY_STATIC);
+
+        ComputeSplits(zNear);
+        glm::mat4 invView = glm::inverse(view);
+        for (int c = 0; c < CASCADES; c++) {
+            glm::vec3 center;
+            float radius;
+            CascadeSphere(invView, fovY, aspect, splits[c], splits[c + 1], center, radius);
+            glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+
+            Cascade &cascade = cascades[c];
+            if (!cascade.valid || !cascade.Contains(lightCenter, radius)) {
+                cascade.Place(lightCenter, radius * (1.0f + cacheMargin), resolution, casterDistance, lightRotation);
+                unsigned long long fallbacks = shaders.fallbacks;
+                RenderLayer(staticMap, c, cascade, scene, true, shaders, cameraBuffer);
+                // Se un caster è stato saltato o disegnato senza la sua variante (es. foglie
+                // senza ALPHA_TEST) la cascata non si tiene: si ridisegna al frame dopo
+                cascade.valid = shaders.fallbacks == fallbacks;
+                stats.cascadesRendered++;
+            } else {
+                stats.cascadesCached++;
+            }
+
+            // Oggetti dinamici: copia della mappa statica + disegno sopra
+            if (hasDynamic) {
+                CopyLayer(c);
+                RenderLayer(finalMap, c, cascade, scene, false, shaders, cameraBuffer);
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glEndQuery(GL_TIME_ELAPSED);
+        frame++;
+
+        sampledMap = hasDynamic ? finalMap : staticMap;
+        UploadBlock();
+        stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Lega la mappa da campionare all'unità fissa letta da shadows.glsl
+    void Bind() {
+        glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, sampledMap);
+        glActiveTexture(GL_TEXTURE0);
+        renderStats.textureBinds++;
+    }
+
+private:
+    struct Cascade {
+        glm::mat4 projection;  // ortografica in spazio luce
+        glm::mat4 matrix;      // projection * rotazione luce
+        glm::vec3 center;      // centro agganciato ai texel, in spazio luce
+        float     halfSize = 0.0f;
+        float     zNear = 0.0f, zFar = 0.0f; // distanze lungo la direzione della luce
+        float     receiverNear = 0.0f;        // zNear senza l'estensione per gli occlusori
+        bool      valid = false;
+
+        // La sfera (in spazio luce) è dentro l'area già disegnata?
+        bool Contains(glm::vec3 const &c, float radius) const {
+            return std::fabs(c.x - center.x) + radius <= halfSize &&
+                   std::fabs(c.y - center.y) + radius <= halfSize &&
+                   -c.z - radius >= receiverNear && -c.z + radius <= zFar;
+        }
+
+        void Place(glm::vec3 const &c, float half, unsigned int resolution, float casterDistance, glm::mat4 const &rotation) {
+            // Dimensione arrotondata e centro agganciato alla griglia dei texel
+            halfSize = std::ceil(half * 16.0f) / 16.0f;
+            float texel = 2.0f * halfSize / resolution;
+            center = glm::vec3(std::floor(c.x / texel) * texel, std::floor(c.y / texel) * texel, c.z);
+            receiverNear = -center.z - halfSize;
+            zNear = receiverNear - casterDistance;
+            zFar  = -center.z + halfSize;
+            projection = glm::ortho(center.x - halfSize, center.x + halfSize, center.y - halfSize, center.y + halfSize, zNear, zFar);
+            matrix = projection * rotation;
+        }
+    };
+
+    // Layout std140 del blocco "Shadows" di shadows.glsl
+    struct ShadowBlock {
+        glm::mat4 cascadeMatrices[CASCADES];
+        glm::vec4 cascadeSplits; // profondità di vista a cui finisce ogni cascata
+        glm::vec4 shadowParams;  // dimensione texel, bias, -, -
+        glm::vec4 cascadeTexels; // lato di un texel in unità mondo, per cascata
+    };
+
+    Cascade cascades[CASCADES];
+    float splits[CASCADES + 1];
+    glm::vec3 lightDirection = glm::vec3(0.0f);
+
+    unsigned int staticMap = 0, finalMap = 0, sampledMap = 0;
+    unsigned int FBO = 0, readFBO = 0, UBO = 0;
+    unsigned int queries[2] = { 0, 0 };
+    unsigned int frame = 0;
+
+    unsigned int CreateArray() {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        gpuMemory.targetBytes += (long long)resolution * resolution * CASCADES * 4;
+        // Confronto in hardware + filtro lineare = PCF 2x2 gratis
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return texture;
+    }
+
+    static glm::mat4 LightRotation(glm::vec3 const &direction) {
+        glm::vec3 dir = glm::normalize(direction);
+        glm::vec3 up = std::fabs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        return glm::lookAt(glm::vec3(0.0f), dir, up);
+    }
+
+    void ComputeSplits(float zNear) {
+        splits[0] = zNear;
+        for (int i = 1; i <= CASCADES; i++) {
+            float p = (float)i / CASCADES;
+            float logSplit = zNear * std::pow(shadowDistance / zNear, p);
+            float linSplit = zNear + (shadowDistance - zNear) * p;
+            splits[i] = splitLambda * logSplit + (1.0f - splitLambda) * linSplit;
+        }
+    }
+
+    // Sfera che contiene la fetta [dNear, dFar] del frustum di vista (world space)
+    static void CascadeSphere(glm::mat4 const &invView, float fovY, float aspect, float dNear, float dFar,
+                              glm::vec3 &center, float &radius) {
+        float tanY = std::tan(fovY * 0.5f), tanX = tanY * aspect;
+        glm::vec3 corners[8];
+        int n = 0;
+        for (float d : { dNear, dFar })
+            for (float sx : { -1.0f, 1.0f })
+                for (float sy : { -1.0f, 1.0f })
+                    corners[n++] = glm::vec3(invView * glm::vec4(sx * d * tanX, sy * d * tanY, -d, 1.0f));
+        center = glm::vec3(0.0f);
+        for (int i = 0; i < 8; i++)
+            center += corners[i];
+        center *= 1.0f / 8.0f;
+        radius = 0.0f;
+        for (int i = 0; i < 8; i++)
+            radius = std::max(radius, glm::length(corners[i] - center));
+    }
+
+    // Test box-cascata in spazio luce (verso il sole l'intervallo è già esteso di casterDistance)
+    static bool Overlaps(Cascade const &cascade, AABB const &world, glm::mat4 const &lightRotation) {
+        AABB light = world.Transform(lightRotation);
+        return light.Max.x >= cascade.center.x - cascade.halfSize && light.Min.x <= cascade.center.x + cascade.halfSize &&
+               light.Max.y >= cascade.center.y - cascade.halfSize && light.Min.y <= cascade.center.y + cascade.halfSize &&
+               -light.Min.z >= cascade.zNear && -light.Max.z <= cascade.zFar;
+    }
+
+    void RenderLayer(unsigned int texture, int layer, Cascade const &cascade, SceneComponents const &scene,
+                     bool staticPass, ShaderLibrary &shaders, CameraBuffer &cameraBuffer) {
+        CPU_ZONE("ShadowMaps::RenderLayer");
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (staticPass)
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+        // Matrici della luce nel blocco Camera: shadow.vert usa projection * view come tutti
+        glm::mat4 lightRotation = LightRotation(lightDirection);
+        cameraBuffer.Update(lightRotation, cascade.projection, glm::vec3(0.0f));
+
+        // Polygon offset contro l'acne; le foglie sono a doppia faccia, niente culling
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.5f, 2.0f);
+        for (size_t i = 0; i < scene.Size(); i++) {
+            if (scene.IsStatic(i) != staticPass)
+                continue;
+            stats.casters++;
+            if (!Overlaps(cascade, scene.bounds[i], lightRotation)) {
+                stats.culled++;
+                renderStats.culledObjects++;
+                continue;
+            }
+            stats.drawCalls += scene.models[i]->Draw(shaders, "shadow", scene.transforms[i], 0, SHADER_ALPHA_TEST);
+        }
+        glDisable(GL_POLYGON_OFFSET_FILL);
+    }
+
+    // Copia la cascata statica nella mappa finale (blit della profondità)
+    void CopyLayer(int layer) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticMap, 0, layer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, finalMap, 0, layer);
+        glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    }
+
+    void UploadBlock() {
+        ShadowBlock block;
+        for (int c = 0; c < CASCADES; c++)
+            block.cascadeMatrices[c] = cascades[c].matrix;
+        block.cascadeSplits = glm::vec4(splits[1], splits[2], splits[3], splits[4]);
+        block.shadowParams = glm::vec4(1.0f / resolution, depthBias, 0.0f, 0.0f);
+        // Calcolato qui: dalla matrice combinata (proiezione * rotazione della
+        // luce) il fattore di scala non si separa dalla rotazione
+        for (int c = 0; c < CASCADES; c++)
+            block.cascadeTexels[c] = 2.0f * cascades[c].halfSize / resolution;
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        renderStats.bufferBytes += sizeof(block);
+    }
+
+    // Risultato del timer query di due frame fa (già pronto: niente stalli)
+    double ReadGpuTime() {
+        if (frame < 2)
+            return 0.0;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[frame & 1], GL_QUERY_RESULT, &ns);
+        return ns / 1.0e6;
+    }
+};
+
+#endif
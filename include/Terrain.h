@@ -0,0 +1,352 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "RenderStats.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Unità texture fissa della heightmap letta da terrain.vert
+const unsigned int TERRAIN_HEIGHT_UNIT = 15;
+
+// Un nodo del quadtree scelto per il frame: angolo (x, z), lato e livello di LOD
+struct TerrainNode {
+    float x, z, size;
+    unsigned int level;
+};
+
+// --- TERRENO CON LOD CONTINUO (CDLOD) ---
+// La heightmap sta in una texture R16 e il vertex shader ne legge l'altezza:
+// ogni nodo del quadtree si disegna con la stessa griglia di gridSize x gridSize
+// quadrati, scalata sul suo lato. Il livello 0 (foglie) copre lodRange metri
+// dalla camera e ogni livello raddoppia sia il lato dei nodi sia la distanza,
+// quindi i triangoli a schermo restano circa costanti e anche chilometri di
+// terreno costano poco più di un centinaio di draw. Nell'ultimo tratto di ogni
+// raggio i vertici dispari scivolano sui pari (geomorphing): al cambio di
+// livello la griglia è già quella del livello più grossolano, niente scatti né
+// crepe. Una piramide min/max delle altezze dà box stretti per frustum e raggi.
+class Terrain {
+public:
+    float size = 4096.0f;        // lato in metri, centrato sull'origine
+    float baseHeight = -2.0f;    // quota dell'altezza 0 (il piano su cui poggiano gli alberi)
+    float heightScale = 120.0f;  // quota dell'altezza massima sopra baseHeight
+    float leafSize = 16.0f;      // lato dei nodi foglia
+    // Raggio del livello 0 (raddoppia a ogni livello) e parte finale di ogni raggio
+    // in cui la griglia si trasforma. Senza crepe se lodRange * (1 - 2 * morphFraction)
+    // supera la diagonale di una foglia: un nodo non arriva mai dove il padre morpha.
+    float lodRange = 64.0f;
+    float morphFraction = 0.3f;
+    float textureTiling = 0.25f; // ripetizioni della texture per metro
+    unsigned int gridSize = 32;  // quadrati per lato della griglia condivisa
+
+    std::vector<TerrainNode> nodes; // scelti dall'ultima Select()
+
+    // Heightmap PNG a 16 bit (quadrata, anche 8 bit); percorso vuoto o file
+    // illeggibile: terreno procedurale dal seed, con una radura piana al centro
+    bool Create(std::string const &heightmapPath, std::string const &textureDirectory, unsigned int seed) {
+        CPU_ZONE("Terrain::Create");
+        LoadHeights(heightmapPath, seed);
+
+        glGenTextures(1, &heightmap);
+        glBindTexture(GL_TEXTURE_2D, heightmap);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2); // righe di 2 * resolution byte
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, resolution, resolution, 0, GL_RED, GL_UNSIGNED_SHORT, heights.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gpuMemory.textureBytes += (long long)resolution * resolution * 2;
+
+        texture = TextureFromFile("grass.jpg", textureDirectory);
+        CreateGrid();
+        std::cout << "TERRENO: " << resolution << "x" << resolution << " campioni, " << size << " m, "
+                  << levels << " livelli di LOD" << std::endl;
+        return true;
+    }
+
+    // Solo la parte CPU di Create(): altezze e piramide min/max, senza contesto GL
+    void LoadHeights(std::string const &heightmapPath, unsigned int seed) {
+        if (heightmapPath.empty() || !LoadHeightmap(heightmapPath))
+            GenerateHeightmap(2049, seed);
+        BuildMinMax();
+    }
+
+    // Altezza in coordinate mondo (bilineare, come il filtro della texture)
+    float HeightAt(float x, float z) const {
+        float u = glm::clamp((x / size + 0.5f) * (resolution - 1), 0.0f, (float)(resolution - 1));
+        float v = glm::clamp((z / size + 0.5f) * (resolution - 1), 0.0f, (float)(resolution - 1));
+        int x0 = std::min((int)u, resolution - 2), z0 = std::min((int)v, resolution - 2);
+        float fx = u - x0, fz = v - z0;
+        float top = glm::mix(Sample(x0, z0), Sample(x0 + 1, z0), fx);
+        float bottom = glm::mix(Sample(x0, z0 + 1), Sample(x0 + 1, z0 + 1), fx);
+        return baseHeight + glm::mix(top, bottom, fz) * heightScale;
+    }
+
+    // Normale in coordinate mondo (differenze centrali, come terrain.vert)
+    glm::vec3 NormalAt(float x, float z) const {
+        float step = size / (resolution - 1);
+        float dx = HeightAt(x + step, z) - HeightAt(x - step, z);
+        float dz = HeightAt(x, z + step) - HeightAt(x, z - step);
+        return glm::normalize(glm::vec3(-dx, 2.0f * step, -dz));
+    }
+
+    // Sceglie i nodi da disegnare: dalla radice si scende finché il nodo entra
+    // nel raggio del livello inferiore; i nodi fuori dal frustum si scartano
+    void Select(glm::mat4 const &viewProjection, glm::vec3 const &cameraPosition) {
+        CPU_ZONE("Terrain::Select");
+        nodes.clear();
+        culledNodes = 0;
+        Frustum frustum(viewProjection);
+        SelectNode(frustum, cameraPosition, 0, 0, levels - 1);
+    }
+
+    // Disegna i nodi scelti con la famiglia 'family' (terrain.vert + un fragment della scena)
+    void Render(ShaderLibrary &shaders, std::string const &family, unsigned int features = 0) {
+        CPU_ZONE("Terrain::Render");
+        unsigned int program = shaders.Get(family, features);
+        if (!program || nodes.empty())
+            return;
+        glUseProgram(program);
+        glActiveTexture(GL_TEXTURE0 + TERRAIN_HEIGHT_UNIT);
+        glBindTexture(GL_TEXTURE_2D, heightmap);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glUniform1i(glGetUniformLocation(program, "texture_diffuse1"), 0);
+        glUniform4f(glGetUniformLocation(program, "terrainArea"), -0.5f * size, -0.5f * size, size, heightScale);
+        glUniform1f(glGetUniformLocation(program, "terrainBase"), baseHeight);
+        glUniform1f(glGetUniformLocation(program, "gridSize"), (float)gridSize);
+        glUniform1f(glGetUniformLocation(program, "textureTiling"), textureTiling);
+        int nodeLocation = glGetUniformLocation(program, "terrainNode");
+        int morphLocation = glGetUniformLocation(program, "terrainMorph");
+
+        glBindVertexArray(VAO);
+        for (TerrainNode const &node : nodes) {
+            float end = Range(node.level), start = end * (1.0f - morphFraction);
+            glUniform3f(nodeLocation, node.x, node.z, node.size);
+            glUniform2f(morphLocation, start, end);
+            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        }
+        glBindVertexArray(0);
+
+        renderStats.drawCalls += nodes.size();
+        renderStats.instances += nodes.size();
+        renderStats.triangles += nodes.size() * indexCount / 3;
+        renderStats.vertices += nodes.size() * (gridSize + 1) * (gridSize + 1);
+        renderStats.programBinds++;
+        renderStats.vaoBinds++;
+        renderStats.textureBinds += 2;
+        renderStats.uniformUploads += 5 + 2 * nodes.size();
+        renderStats.culledObjects += culledNodes;
+    }
+
+    // Per chi legge la heightmap in altri shader (erba), sull'unità TERRAIN_HEIGHT_UNIT
+    unsigned int HeightmapTexture() const { return heightmap; }
+
+    // Raggio del livello 'level' (vale per la distanza 3D dalla camera)
+    float Range(unsigned int level) const { return lodRange * (float)(1u << level); }
+
+private:
+    int resolution = 0;            // campioni per lato (2^n + 1)
+    std::vector<uint16_t> heights;
+    unsigned int levels = 1;
+    // Per livello, min/max normalizzati [0, 1] di ogni nodo (riga per riga)
+    std::vector<std::vector<glm::vec2>> minMax;
+    unsigned int culledNodes = 0;
+
+    unsigned int heightmap = 0, texture = 0;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    int indexCount = 0;
+
+    float Sample(int x, int z) const { return heights[(size_t)z * resolution + x] / 65535.0f; }
+
+    bool LoadHeightmap(std::string const &path) {
+        CPU_ZONE("stbi_load_16");
+        int width, height, components;
+        stbi_us *data = stbi_load_16(path.c_str(), &width, &height, &components, 1);
+        if (!data) {
+            std::cout << "ERRORE::TERRAIN:: impossibile leggere " << path << ", uso il terreno procedurale" << std::endl;
+            return false;
+        }
+        if (width != height || width < 3) {
+            std::cout << "ERRORE::TERRAIN:: heightmap non quadrata " << width << "x" << height << std::endl;
+            stbi_image_free(data);
+            return false;
+        }
+        resolution = width;
+        heights.assign(data, data + (size_t)width * height);
+        stbi_image_free(data);
+        std::cout << "TERRENO: heightmap " << path << std::endl;
+        return true;
+    }
+
+    // Value noise deterministico dal seed
+    static float Hash(int x, int z, unsigned int seed) {
+        uint32_t h = (uint32_t)x * 374761393u + (uint32_t)z * 668265263u + seed * 2246822519u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return (float)((h ^ (h >> 16)) & 0xFFFFFFu) / (float)0xFFFFFF;
+    }
+
+    static float ValueNoise(float x, float z, unsigned int seed) {
+        int x0 = (int)std::floor(x), z0 = (int)std::floor(z);
+        float fx = x - x0, fz = z - z0;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fz = fz * fz * (3.0f - 2.0f * fz);
+        float top = glm::mix(Hash(x0, z0, seed), Hash(x0 + 1, z0, seed), fx);
+        float bottom = glm::mix(Hash(x0, z0 + 1, seed), Hash(x0 + 1, z0 + 1, seed), fx);
+        return glm::mix(top, bottom, fz);
+    }
+
+    // fBm a 6 ottave, righe in parallelo. Entro 30 m dall'origine il terreno è
+    // piano a baseHeight (la scena esistente), poi sale fino a 80 m.
+    void GenerateHeightmap(int samples, unsigned int seed) {
+        CPU_ZONE("Terrain::GenerateHeightmap");
+        resolution = samples;
+        heights.resize((size_t)samples * samples);
+        float spacing = size / (samples - 1);
+        jobs.ParallelFor(samples, 16, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++) {
+                for (int column = 0; column < samples; column++) {
+                    float x = column * spacing - 0.5f * size, z = row * spacing - 0.5f * size;
+                    float value = 0.0f, amplitude = 0.5f, frequency = 1.0f / 600.0f;
+                    for (unsigned int octave = 0; octave < 6; octave++) {
+                        value += amplitude * ValueNoise(x * frequency, z * frequency, seed + octave);
+                        amplitude *= 0.5f;
+                        frequency *= 2.0f;
+                    }
+                    value = glm::clamp(value / 0.984375f, 0.0f, 1.0f); // somma delle ampiezze
+                    float clearing = glm::smoothstep(30.0f, 80.0f, std::sqrt(x * x + z * z));
+                    heights[row * samples + column] = (uint16_t)(value * value * clearing * 65535.0f);
+                }
+            }
+        });
+    }
+
+    void BuildMinMax() {
+        CPU_ZONE("Terrain::BuildMinMax");
+        unsigned int leaves = (unsigned int)std::max(1.0f, size / leafSize);
+        levels = 1;
+        while ((1u << (levels - 1)) < leaves)
+            levels++;
+        minMax.assign(levels, {});
+
+        // Foglie dai campioni (bordi compresi), poi ogni livello dai 4 figli
+        unsigned int count = 1u << (levels - 1);
+        minMax[0].resize((size_t)count * count);
+        float samplesPerNode = (float)(resolution - 1) / count;
+        jobs.ParallelFor(count, 8, [&](size_t begin, size_t end) {
+            for (size_t nz = begin; nz < end; nz++) {
+                for (unsigned int nx = 0; nx < count; nx++) {
+                    int x0 = (int)(nx * samplesPerNode), x1 = std::min(resolution - 1, (int)std::ceil((nx + 1) * samplesPerNode));
+                    int z0 = (int)(nz * samplesPerNode), z1 = std::min(resolution - 1, (int)std::ceil((nz + 1) * samplesPerNode));
+                    glm::vec2 range(1.0f, 0.0f);
+                    for (int z = z0; z <= z1; z++)
+                        for (int x = x0; x <= x1; x++)
+                            range = glm::vec2(std::min(range.x, Sample(x, z)), std::max(range.y, Sample(x, z)));
+                    minMax[0][nz * count + nx] = range;
+                }
+            }
+        });
+        for (unsigned int level = 1; level < levels; level++) {
+            unsigned int parents = count >> level, children = parents * 2;
+            minMax[level].resize((size_t)parents * parents);
+            for (unsigned int z = 0; z < parents; z++) {
+                for (unsigned int x = 0; x < parents; x++) {
+                    std::vector<glm::vec2> const &below = minMax[level - 1];
+                    glm::vec2 a = below[(2 * z) * children + 2 * x], b = below[(2 * z) * children + 2 * x + 1];
+                    glm::vec2 c = below[(2 * z + 1) * children + 2 * x], d = below[(2 * z + 1) * children + 2 * x + 1];
+                    minMax[level][z * parents + x] = glm::vec2(std::min(std::min(a.x, b.x), std::min(c.x, d.x)),
+                                                               std::max(std::max(a.y, b.y), std::max(c.y, d.y)));
+                }
+            }
+        }
+    }
+
+    // Box del nodo (x, z) del livello 'level', in coordinate mondo
+    AABB NodeBounds(unsigned int x, unsigned int z, unsigned int level) const {
+        unsigned int count = 1u << (levels - 1 - level);
+        float nodeSize = size / count;
+        glm::vec2 range = minMax[level][(size_t)z * count + x];
+        AABB box;
+        box.Min = glm::vec3(x * nodeSize - 0.5f * size, baseHeight + range.x * heightScale, z * nodeSize - 0.5f * size);
+        box.Max = glm::vec3(box.Min.x + nodeSize, baseHeight + range.y * heightScale, box.Min.z + nodeSize);
+        return box;
+    }
+
+    static bool InSphere(AABB const &box, glm::vec3 const &center, float radius) {
+        glm::vec3 d = glm::max(glm::max(box.Min - center, center - box.Max), glm::vec3(0.0f));
+        return glm::dot(d, d) <= radius * radius;
+    }
+
+    // Falso se il nodo è fuori dal proprio raggio: lo copre allora il padre.
+    // I figli fuori dal loro raggio si disegnano comunque al proprio livello:
+    // lì il morph vale 1 e la griglia coincide con quella del padre.
+    bool SelectNode(Frustum const &frustum, glm::vec3 const &camera, unsigned int x, unsigned int z, unsigned int level) {
+        AABB box = NodeBounds(x, z, level);
+        if (!InSphere(box, camera, Range(level)))
+            return false;
+        if (!frustum.Intersects(box)) {
+            culledNodes++;
+            return true;
+        }
+        if (level == 0 || !InSphere(box, camera, Range(level - 1))) {
+            nodes.push_back({ box.Min.x, box.Min.z, box.Max.x - box.Min.x, level });
+            return true;
+        }
+        for (unsigned int child = 0; child < 4; child++) {
+            unsigned int cx = 2 * x + (child & 1), cz = 2 * z + (child >> 1);
+            if (!SelectNode(frustum, camera, cx, cz, level - 1)) {
+                AABB childBox = NodeBounds(cx, cz, level - 1);
+                if (frustum.Intersects(childBox))
+                    nodes.push_back({ childBox.Min.x, childBox.Min.z, childBox.Max.x - childBox.Min.x, level - 1 });
+                else
+                    culledNodes++;
+            }
+        }
+        return true;
+    }
+
+    // Griglia condivisa: (gridSize + 1)^2 vertici in [0, 1]^2, location 0
+    void CreateGrid() {
+        std::vector<glm::vec2> vertices;
+        std::vector<unsigned int> indices;
+        for (unsigned int z = 0; z <= gridSize; z++)
+            for (unsigned int x = 0; x <= gridSize; x++)
+                vertices.push_back(glm::vec2((float)x, (float)z) / (float)gridSize);
+        for (unsigned int z = 0; z < gridSize; z++) {
+            for (unsigned int x = 0; x < gridSize; x++) {
+                unsigned int i = z * (gridSize + 1) + x;
+                // Antiorario visto dall'alto (+Y)
+                indices.insert(indices.end(), { i, i + gridSize + 1, i + 1, i + 1, i + gridSize + 1, i + gridSize + 2 });
+            }
+        }
+        indexCount = (int)indices.size();
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        glBindVertexArray(0);
+        gpuMemory.bufferBytes += vertices.size() * sizeof(glm::vec2) + indices.size() * sizeof(unsigned int);
+    }
+};
+
+#endif
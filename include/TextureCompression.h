@@ -0,0 +1,632 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Formati a blocchi 4x4 della GPU
+enum TextureFormat : uint32_t {
+    TEXTURE_BC1, // RGB opaco, 8 byte per blocco (4 bit per texel)
+    TEXTURE_BC3, // RGB + alfa interpolato, 16 byte
+    TEXTURE_BC4, // un canale (texture in scala di grigi), 8 byte
+    TEXTURE_BC5, // due canali: X e Y delle normal map, Z ricostruita nello shader
+    TEXTURE_BC7, // RGBA di qualità (solo modo 6), 16 byte
+    TEXTURE_FORMAT_COUNT
+};
+
+struct TextureFormatInfo {
+    const char *name;
+    GLenum glFormat;
+    uint32_t vkFormat;      // codice VkFormat scritto nel file KTX2
+    unsigned int blockBytes;
+};
+
+inline TextureFormatInfo const &FormatInfo(TextureFormat format) {
+    static const TextureFormatInfo infos[TEXTURE_FORMAT_COUNT] = {
+        { "BC1", GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 131, 8 },
+        { "BC3", GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 137, 16 },
+        { "BC4", GL_COMPRESSED_RED_RGTC1, 139, 8 },
+        { "BC5", GL_COMPRESSED_RG_RGTC2, 141, 16 },
+        { "BC7", GL_COMPRESSED_RGBA_BPTC_UNORM, 145, 16 },
+    };
+    return infos[format];
+}
+
+// Texture compressa con tutta la catena di mipmap (livello 0 = piena risoluzione)
+struct CompressedTexture {
+    TextureFormat format = TEXTURE_BC1;
+    int width = 0, height = 0;
+    std::vector<std::vector<unsigned char>> levels;
+
+    bool HasAlpha() const { return format == TEXTURE_BC3 || format == TEXTURE_BC7; }
+
+    size_t Bytes() const {
+        size_t bytes = 0;
+        for (auto const &level : levels)
+            bytes += level.size();
+        return bytes;
+    }
+
+    static size_t LevelBytes(TextureFormat format, int width, int height) {
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * FormatInfo(format).blockBytes;
+    }
+};
+
+// --- CODIFICA DEI BLOCCHI ---
+// Codificatori veloci pensati per girare al caricamento: estremi sull'asse
+// principale dei colori del blocco (PCA), poi per ogni texel l'indice del
+// colore più vicino della tavolozza che la GPU ricostruisce. 'rgba' sono i
+// 16 texel del blocco, 4 byte ciascuno, riga per riga.
+namespace BlockEncoder {
+
+// Asse principale di 'channels' componenti con qualche passo del metodo delle potenze
+inline void PrincipalAxis(const unsigned char *rgba, int channels, float mean[4], float axis[4]) {
+    float covariance[4][4] = {};
+    for (int c = 0; c < channels; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++)
+            mean[c] += rgba[i * 4 + c];
+        mean[c] /= 16.0f;
+    }
+    for (int i = 0; i < 16; i++)
+        for (int a = 0; a < channels; a++)
+            for (int b = 0; b < channels; b++)
+                covariance[a][b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+    for (int c = 0; c < 4; c++)
+        axis[c] = c < channels ? 1.0f : 0.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {}, length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++)
+                next[a] += covariance[a][b] * axis[b];
+            length = std::max(length, std::fabs(next[a]));
+        }
+        if (length < 1e-6f) {
+            std::fill(axis, axis + 4, 0.0f); // blocco di un colore solo
+            return;
+        }
+        for (int c = 0; c < channels; c++)
+            axis[c] = next[c] / length;
+    }
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++)
+        length += axis[c] * axis[c];
+    length = std::sqrt(length);
+    for (int c = 0; c < channels; c++)
+        axis[c] /= length;
+}
+
+// Estremi del blocco: proiezioni minima e massima sull'asse principale
+inline void Endpoints(const unsigned char *rgba, int channels, float low[4], float high[4]) {
+    float mean[4], axis[4];
+    PrincipalAxis(rgba, channels, mean, axis);
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++)
+            t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < channels; c++) {
+        low[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+// Indice del colore della tavolozza più vicino (errore quadratico sui canali)
+inline int Nearest(const unsigned char *texel, int const palette[][4], int count, int channels) {
+    int best = 0, bestError = 1 << 30;
+    for (int p = 0; p < count; p++) {
+        int error = 0;
+        for (int c = 0; c < channels; c++) {
+            int d = texel[c] - palette[p][c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = p;
+        }
+    }
+    return best;
+}
+
+inline uint16_t Pack565(float const color[3]) {
+    int r = (int)std::lround(color[0] * 31.0f / 255.0f), g = (int)std::lround(color[1] * 63.0f / 255.0f);
+    int b = (int)std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void Unpack565(uint16_t packed, int color[4]) {
+    int r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+    color[3] = 255;
+}
+
+// Blocco colore BC1 a quattro colori (anche la metà colore di BC3); l'alfa si ignora
+inline void EncodeColorBlock(const unsigned char *rgba, unsigned char *out) {
+    float low[4], high[4];
+    Endpoints(rgba, 3, low, high);
+    // Estremi rientrati di 1/16: l'errore medio scende sui blocchi con texel isolati
+    for (int c = 0; c < 3; c++) {
+        float inset = (high[c] - low[c]) / 16.0f;
+        low[c] += inset;
+        high[c] -= inset;
+    }
+    uint16_t c0 = Pack565(high), c1 = Pack565(low);
+    if (c0 < c1)
+        std::swap(c0, c1);
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][4];
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++)
+            indices |= (uint32_t)Nearest(rgba + i * 4, palette, 4, 3) << (i * 2);
+    }
+    out[0] = (unsigned char)c0;
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)c1;
+    out[3] = (unsigned char)(c1 >> 8);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// Blocco di un canale (BC4, l'alfa di BC3, ciascuna metà di BC5): 8 valori fra minimo e massimo
+inline void EncodeChannelBlock(const unsigned char *rgba, int channel, unsigned char *out) {
+    int low = 255, high = 0;
+    for (int i = 0; i < 16; i++) {
+        low = std::min<int>(low, rgba[i * 4 + channel]);
+        high = std::max<int>(high, rgba[i * 4 + channel]);
+    }
+    uint64_t bits = (uint64_t)high | ((uint64_t)low << 8);
+    if (high != low) {
+        int palette[8];
+        palette[0] = high;
+        palette[1] = low;
+        for (int p = 2; p < 8; p++)
+            palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+        for (int i = 0; i < 16; i++) {
+            int value = rgba[i * 4 + channel], best = 0;
+            for (int p = 1; p < 8; p++)
+                if (std::abs(palette[p] - value) < std::abs(palette[best] - value))
+                    best = p;
+            bits |= (uint64_t)best << (16 + i * 3);
+        }
+    }
+    for (int b = 0; b < 8; b++)
+        out[b] = (unsigned char)(bits >> (b * 8));
+}
+
+// Scrittura di campi di bit dal meno significativo (ordine dei blocchi BC7)
+struct BitWriter {
+    unsigned char *out;
+    int position = 0;
+
+    void Write(uint32_t value, int count) {
+        for (int b = 0; b < count; b++, position++)
+            if (value >> b & 1)
+                out[position >> 3] |= (unsigned char)(1 << (position & 7));
+    }
+};
+
+// BC7 modo 6: un solo sottoinsieme RGBA, estremi a 7 bit + bit P, indici a 4 bit.
+// Il colore dei texel del tutto trasparenti non conta (l'alpha test li scarta):
+// la precisione va ai texel visibili.
+inline int ChannelWeight(const unsigned char *texel, int channel) { return channel == 3 || texel[3] > 0 ? 1 : 0; }
+
+struct BC7Fit {
+    int quantized[2][4], pbit[2], index[16];
+    int error = 1 << 30;
+
+    // Quantizza gli estremi (per ognuno il bit P condiviso che sbaglia meno) e sceglie gli indici
+    void Evaluate(const unsigned char *rgba, float const endpoints[2][4]) {
+        static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        for (int e = 0; e < 2; e++) {
+            float bestError = 1e30f;
+            for (int p = 0; p < 2; p++) {
+                int q[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++) {
+                    q[c] = std::clamp((int)std::lround((endpoints[e][c] - p) / 2.0f), 0, 127);
+                    float d = (float)((q[c] << 1) | p) - endpoints[e][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    pbit[e] = p;
+                    std::copy(q, q + 4, quantized[e]);
+                }
+            }
+        }
+        int palette[16][4];
+        for (int w = 0; w < 16; w++)
+            for (int c = 0; c < 4; c++) {
+                int e0 = (quantized[0][c] << 1) | pbit[0], e1 = (quantized[1][c] << 1) | pbit[1];
+                palette[w][c] = ((64 - weights[w]) * e0 + weights[w] * e1 + 32) >> 6;
+            }
+        error = 0;
+        for (int i = 0; i < 16; i++) {
+            int bestError = 1 << 30;
+            for (int p = 0; p < 16; p++) {
+                int e = 0;
+                for (int c = 0; c < 4; c++) {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    e += ChannelWeight(rgba + i * 4, c) * d * d;
+                }
+                if (e < bestError) {
+                    bestError = e;
+                    index[i] = p;
+                }
+            }
+            error += bestError;
+        }
+    }
+
+    // Estremi ai minimi quadrati per gli indici scelti: il texel i vale (1 - t) e0 + t e1
+    bool Refine(const unsigned char *rgba, float endpoints[2][4]) const {
+        static const float weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        bool changed = false;
+        for (int c = 0; c < 4; c++) {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax = 0.0f, bx = 0.0f;
+            for (int i = 0; i < 16; i++) {
+                float t = weights[index[i]] / 64.0f, s = 1.0f - t, w = (float)ChannelWeight(rgba + i * 4, c);
+                aa += w * s * s;
+                ab += w * s * t;
+                bb += w * t * t;
+                ax += w * s * rgba[i * 4 + c];
+                bx += w * t * rgba[i * 4 + c];
+            }
+            float determinant = aa * bb - ab * ab;
+            if (std::fabs(determinant) < 1e-6f)
+                continue; // texel tutti sullo stesso indice: il canale resta com'è
+            endpoints[0][c] = std::clamp((bb * ax - ab * bx) / determinant, 0.0f, 255.0f);
+            endpoints[1][c] = std::clamp((aa * bx - ab * ax) / determinant, 0.0f, 255.0f);
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+inline void EncodeBC7Block(const unsigned char *rgba, unsigned char *out) {
+    // Due partenze: l'asse principale e la diagonale del box dei canali (meglio
+    // quando alfa e colore non sono correlati, come nel fogliame ritagliato);
+    // ognuna si rifinisce ai minimi quadrati e si tiene la migliore
+    float starts[2][2][4];
+    Endpoints(rgba, 4, starts[0][0], starts[0][1]);
+    for (int c = 0; c < 4; c++) {
+        starts[1][0][c] = 255.0f;
+        starts[1][1][c] = 0.0f;
+        for (int i = 0; i < 16; i++)
+            if (ChannelWeight(rgba + i * 4, c)) {
+                starts[1][0][c] = std::min<float>(starts[1][0][c], rgba[i * 4 + c]);
+                starts[1][1][c] = std::max<float>(starts[1][1][c], rgba[i * 4 + c]);
+            }
+        if (starts[1][0][c] > starts[1][1][c])
+            starts[1][0][c] = starts[1][1][c] = 0.0f; // blocco tutto trasparente
+    }
+    BC7Fit best;
+    for (auto &endpoints : starts) {
+        for (int iteration = 0; iteration < 3; iteration++) {
+            BC7Fit fit;
+            fit.Evaluate(rgba, endpoints);
+            if (fit.error < best.error)
+                best = fit;
+            if (fit.error == 0 || !fit.Refine(rgba, endpoints))
+                break;
+        }
+    }
+
+    // Il bit alto dell'indice del primo texel è implicito a zero: se serve si scambiano gli estremi
+    if (best.index[0] & 8) {
+        std::swap(best.quantized[0], best.quantized[1]);
+        std::swap(best.pbit[0], best.pbit[1]);
+        for (int &i : best.index)
+            i = 15 - i;
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter bits{ out };
+    bits.Write(1 << 6, 7); // modo 6
+    for (int c = 0; c < 4; c++) {
+        bits.Write((uint32_t)best.quantized[0][c], 7);
+        bits.Write((uint32_t)best.quantized[1][c], 7);
+    }
+    bits.Write((uint32_t)best.pbit[0], 1);
+    bits.Write((uint32_t)best.pbit[1], 1);
+    bits.Write((uint32_t)best.index[0], 3);
+    for (int i = 1; i < 16; i++)
+        bits.Write((uint32_t)best.index[i], 4);
+}
+
+inline void EncodeBlock(TextureFormat format, const unsigned char *rgba, unsigned char *out) {
+    switch (format) {
+    case TEXTURE_BC1: EncodeColorBlock(rgba, out); break;
+    case TEXTURE_BC3:
+        EncodeChannelBlock(rgba, 3, out);
+        EncodeColorBlock(rgba, out + 8);
+        break;
+    case TEXTURE_BC4: EncodeChannelBlock(rgba, 0, out); break;
+    case TEXTURE_BC5:
+        EncodeChannelBlock(rgba, 0, out);
+        EncodeChannelBlock(rgba, 1, out + 8);
+        break;
+    default: EncodeBC7Block(rgba, out); break;
+    }
+}
+
+} // namespace BlockEncoder
+
+// Mipmap successiva (media 2x2); per le normal map la media si rinormalizza
+inline std::vector<unsigned char> DownsampleRgba(std::vector<unsigned char> const &source, int width, int height,
+                                                 bool normalMap) {
+    int w = std::max(1, width / 2), h = std::max(1, height / 2);
+    std::vector<unsigned char> out((size_t)w * h * 4);
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++) {
+            float sum[4] = {};
+            for (int dy = 0; dy < 2; dy++)
+                for (int dx = 0; dx < 2; dx++) {
+                    int sx = std::min(x * 2 + dx, width - 1), sy = std::min(y * 2 + dy, height - 1);
+                    for (int c = 0; c < 4; c++)
+                        sum[c] += source[((size_t)sy * width + sx) * 4 + c];
+                }
+            if (normalMap) {
+                float n[3], length = 0.0f;
+                for (int c = 0; c < 3; c++) {
+                    n[c] = sum[c] / (4.0f * 127.5f) - 1.0f;
+                    length += n[c] * n[c];
+                }
+                length = std::sqrt(std::max(length, 1e-8f));
+                for (int c = 0; c < 3; c++)
+                    sum[c] = (n[c] / length + 1.0f) * 127.5f * 4.0f;
+            }
+            for (int c = 0; c < 4; c++)
+                out[((size_t)y * w + x) * 4 + c] = (unsigned char)std::clamp((int)std::lround(sum[c] / 4.0f), 0, 255);
+        }
+    return out;
+}
+
+// Codifica un'immagine RGBA8 con tutta la catena di mipmap (fino a 1x1).
+// I blocchi sul bordo destro e in basso ripetono l'ultimo texel.
+inline CompressedTexture CompressTexture(const unsigned char *rgba, int width, int height, TextureFormat format,
+                                         bool normalMap) {
+    CPU_ZONE("CompressTexture");
+    CompressedTexture texture;
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    std::vector<unsigned char> level(rgba, rgba + (size_t)width * height * 4);
+    unsigned int blockBytes = FormatInfo(format).blockBytes;
+    for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        int blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+        std::vector<unsigned char> blocks((size_t)blocksX * blocksY * blockBytes);
+        jobs.ParallelFor((size_t)blocksY, 8, [&](size_t begin, size_t end) {
+            unsigned char texels[64];
+            for (size_t by = begin; by < end; by++)
+                for (int bx = 0; bx < blocksX; bx++) {
+                    for (int i = 0; i < 16; i++) {
+                        int x = std::min(bx * 4 + (i & 3), w - 1), y = std::min((int)by * 4 + (i >> 2), h - 1);
+                        std::memcpy(texels + i * 4, &level[((size_t)y * w + x) * 4], 4);
+                    }
+                    BlockEncoder::EncodeBlock(format, texels, &blocks[(by * blocksX + bx) * blockBytes]);
+                }
+        });
+        texture.levels.push_back(std::move(blocks));
+        if (w == 1 && h == 1)
+            break;
+        level = DownsampleRgba(level, w, h, normalMap);
+    }
+    return texture;
+}
+
+// Contatori della cache (atomici: si aggiornano dai job di decodifica)
+struct TextureCacheStats {
+    std::atomic<unsigned long> hits{ 0 };      // texture lette già compresse dalla cache
+    std::atomic<unsigned long> encoded{ 0 };   // compresse al caricamento e salvate
+    std::atomic<unsigned long> uncompressed{ 0 }; // rimaste RGBA8 (formato non supportato dal driver)
+    std::atomic<unsigned long long> encodeMicros{ 0 };
+    // Memoria video delle texture caricate: reale e quella che avrebbero in RGBA8
+    std::atomic<unsigned long long> gpuBytes{ 0 }, rgbaBytes{ 0 };
+    std::atomic<unsigned long> formatCount[TEXTURE_FORMAT_COUNT] = {};
+};
+
+// --- CACHE SU DISCO DELLE TEXTURE COMPRESSE ---
+// La prima volta un'immagine si decodifica, si comprime e si salva in
+// <directory>/<chiave>.ktx2; dalle volte successive si carica già compressa e
+// va sulla GPU con glCompressedTexImage2D, senza decodificare il PNG. La
+// chiave è l'hash del file sorgente, quindi un asset modificato si ricomprime.
+// I file seguono l'impaginazione di KTX2 (intestazione, indice dei livelli,
+// mip dalla più piccola) senza il descrittore del formato (DFD), che qui non
+// serve: il formato è nel campo vkFormat.
+class TextureCache {
+public:
+    TextureCacheStats stats;
+    bool enabled = true;
+
+    // Dopo glExt.Load: i formati che il driver accetta
+    void Create(std::string const &directory) {
+        this->directory = directory;
+        supported[TEXTURE_BC1] = supported[TEXTURE_BC3] = glExt.textureS3TC;
+        supported[TEXTURE_BC4] = supported[TEXTURE_BC5] = true; // RGTC è nel core dal 3.0
+        supported[TEXTURE_BC7] = glExt.textureBPTC;
+    }
+
+    bool Enabled() const { return enabled && !directory.empty(); }
+    bool Supported(TextureFormat format) const { return supported[format]; }
+
+    // Formato per un'immagine: BC5 per le normal map, BC7 (o BC3) con l'alfa,
+    // BC4 in scala di grigi, altrimenti BC1. Falso se il driver non ne ha nessuno adatto.
+    bool Choose(bool hasAlpha, bool normalMap, bool grayscale, TextureFormat &format) const {
+        if (normalMap)
+            format = TEXTURE_BC5;
+        else if (hasAlpha)
+            format = supported[TEXTURE_BC7] ? TEXTURE_BC7 : TEXTURE_BC3;
+        else
+            format = grayscale ? TEXTURE_BC4 : TEXTURE_BC1;
+        return supported[format];
+    }
+
+    // Chiave del file sorgente (FNV-1a) insieme al tipo di texture e alla versione del codificatore
+    static uint64_t Key(const unsigned char *data, size_t size, bool normalMap) {
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        hash = (hash ^ (normalMap ? 1u : 0u)) * 1099511628211ull;
+        return (hash ^ VERSION) * 1099511628211ull;
+    }
+
+    bool Load(uint64_t key, CompressedTexture &texture) const {
+        CPU_ZONE("TextureCache::Load");
+        std::ifstream file(PathFor(key), std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        std::vector<unsigned char> bytes((size_t)file.tellg());
+        file.seekg(0);
+        if (!file.read((char *)bytes.data(), bytes.size()) || bytes.size() < sizeof(Ktx2Header))
+            return false;
+        Ktx2Header header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0 || header.levelCount == 0 ||
+            header.pixelWidth == 0 || header.pixelHeight == 0 || header.supercompressionScheme != 0 ||
+            sizeof(Ktx2Header) + header.levelCount * sizeof(Ktx2Level) > bytes.size())
+            return false;
+        int format = 0;
+        while (format < (int)TEXTURE_FORMAT_COUNT && FormatInfo((TextureFormat)format).vkFormat != header.vkFormat)
+            format++;
+        if (format == (int)TEXTURE_FORMAT_COUNT || !supported[format])
+            return false; // cache di un'altra macchina: si rigenera dal sorgente
+        texture.format = (TextureFormat)format;
+        texture.width = (int)header.pixelWidth;
+        texture.height = (int)header.pixelHeight;
+        texture.levels.resize(header.levelCount);
+        int w = texture.width, h = texture.height;
+        for (uint32_t l = 0; l < header.levelCount; l++, w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+            Ktx2Level level;
+            std::memcpy(&level, bytes.data() + sizeof(Ktx2Header) + l * sizeof(Ktx2Level), sizeof(level));
+            if (level.byteLength != CompressedTexture::LevelBytes(texture.format, w, h) ||
+                level.byteOffset > bytes.size() || level.byteLength > bytes.size() - level.byteOffset)
+                return false;
+            texture.levels[l].assign(bytes.begin() + (size_t)level.byteOffset,
+                                     bytes.begin() + (size_t)(level.byteOffset + level.byteLength));
+        }
+        return true;
+    }
+
+    // Scrive su un file temporaneo e poi lo rinomina: una lettura non vede mai un file a metà
+    void Store(uint64_t key, CompressedTexture const &texture) {
+        CPU_ZONE("TextureCache::Store");
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        Ktx2Header header;
+        std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+        header.vkFormat = FormatInfo(texture.format).vkFormat;
+        header.pixelWidth = (uint32_t)texture.width;
+        header.pixelHeight = (uint32_t)texture.height;
+        header.levelCount = (uint32_t)texture.levels.size();
+
+        // Come in KTX2 i dati partono dalla mip più piccola, allineati al blocco
+        std::vector<Ktx2Level> levels(texture.levels.size());
+        uint64_t offset = sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2Level);
+        unsigned int align = FormatInfo(texture.format).blockBytes;
+        for (size_t l = levels.size(); l-- > 0;) {
+            offset = (offset + align - 1) / align * align;
+            levels[l] = { offset, texture.levels[l].size(), texture.levels[l].size() };
+            offset += texture.levels[l].size();
+        }
+        std::vector<unsigned char> bytes((size_t)offset, 0);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        std::memcpy(bytes.data() + sizeof(header), levels.data(), levels.size() * sizeof(Ktx2Level));
+        for (size_t l = 0; l < levels.size(); l++)
+            std::memcpy(bytes.data() + levels[l].byteOffset, texture.levels[l].data(), texture.levels[l].size());
+
+        std::string path = PathFor(key);
+        std::string temporary = path + "." + std::to_string(temporaryCounter++) + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary);
+            if (!file.write((const char *)bytes.data(), bytes.size())) {
+                std::cout << "ERRORE::TEXTURE_CACHE:: impossibile scrivere " << temporary << std::endl;
+                return;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+            std::filesystem::remove(temporary, error);
+    }
+
+    // Memoria video risparmiata, per il riepilogo dopo il caricamento
+    void Report() const {
+        double gpuMb = stats.gpuBytes / (1024.0 * 1024.0), rgbaMb = stats.rgbaBytes / (1024.0 * 1024.0);
+        char line[160];
+        std::snprintf(line, sizeof(line), "TEXTURE: %.1f MB in VRAM invece di %.1f MB in RGBA8 (-%.0f%%)", gpuMb, rgbaMb,
+                      rgbaMb > 0.0 ? 100.0 * (1.0 - gpuMb / rgbaMb) : 0.0);
+        std::cout << line << ", " << stats.hits << " dalla cache, " << stats.encoded << " compresse in "
+                  << stats.encodeMicros / 1000 << " ms, " << stats.uncompressed << " non compresse [";
+        for (int f = 0; f < (int)TEXTURE_FORMAT_COUNT; f++)
+            std::cout << (f ? " " : "") << FormatInfo((TextureFormat)f).name << ":" << stats.formatCount[f];
+        std::cout << "]" << std::endl;
+    }
+
+private:
+    static constexpr uint32_t VERSION = 1; // da cambiare quando cambia il codificatore
+    static constexpr unsigned char IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // Intestazione e indice di KTX2 (tutto little endian)
+    struct Ktx2Header {
+        unsigned char identifier[12];
+        uint32_t vkFormat = 0;
+        uint32_t typeSize = 1;
+        uint32_t pixelWidth = 0, pixelHeight = 0, pixelDepth = 0;
+        uint32_t layerCount = 0, faceCount = 1, levelCount = 0;
+        uint32_t supercompressionScheme = 0;
+        uint32_t dfdByteOffset = 0, dfdByteLength = 0;
+        uint32_t kvdByteOffset = 0, kvdByteLength = 0;
+        uint64_t sgdByteOffset = 0, sgdByteLength = 0;
+    };
+    struct Ktx2Level {
+        uint64_t byteOffset, byteLength, uncompressedByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80, "intestazione KTX2 di 80 byte");
+
+    std::string directory;
+    bool supported[TEXTURE_FORMAT_COUNT] = {};
+    std::atomic<unsigned int> temporaryCounter{ 0 };
+
+    std::string PathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.ktx2", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+};
+
+// Istanza globale, creata in main con il contesto GL prima di caricare i modelli
+inline TextureCache textureCache;
+
+// Tempo trascorso in microsecondi, per stats.encodeMicros
+inline unsigned long long MicrosSince(std::chrono::high_resolution_clock::time_point start) {
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+#endif
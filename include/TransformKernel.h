@@ -0,0 +1,228 @@
+#ifndef TRANSFORM_KERNEL_H
+#define TRANSFORM_KERNEL_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Scene.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// --- KERNEL SIMD DELLE TRASFORMAZIONI ---
+// Matrici mondo da traslazione/rotazione/scala in SoA e box/sfere in coordinate
+// mondo, a blocchi. Il set di istruzioni si sceglie a compilazione: AVX2 + FMA
+// con l'opzione CMake TRANSFORM_AVX2, altrimenti SSE (sempre presente su
+// x86-64), altrimenti il percorso scalare, usato anche per gli elementi in coda.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define TRANSFORM_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_KERNEL_SSE
+#include <emmintrin.h>
+#endif
+
+inline const char *TransformKernelName() {
+#if defined(TRANSFORM_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(TRANSFORM_KERNEL_SSE)
+    return "SSE";
+#else
+    return "scalare";
+#endif
+}
+
+// Traslazione, rotazione (quaternione unitario) e scala, un array per componente
+struct TransformSoA {
+    std::vector<float> px, py, pz;
+    std::vector<float> qx, qy, qz, qw;
+    std::vector<float> sx, sy, sz;
+
+    size_t Size() const { return px.size(); }
+
+    void Reserve(size_t count) {
+        for (std::vector<float> *array : { &px, &py, &pz, &qx, &qy, &qz, &qw, &sx, &sy, &sz })
+            array->reserve(count);
+    }
+
+    void Push(glm::vec3 const &position, glm::quat const &rotation, glm::vec3 const &scale) {
+        px.push_back(position.x); py.push_back(position.y); pz.push_back(position.z);
+        qx.push_back(rotation.x); qy.push_back(rotation.y); qz.push_back(rotation.z); qw.push_back(rotation.w);
+        sx.push_back(scale.x); sy.push_back(scale.y); sz.push_back(scale.z);
+    }
+};
+
+// --- PERCORSO SCALARE ---
+
+// T * R * S con le colonne scritte direttamente (stessa matrice di
+// glm::translate * glm::mat4_cast * glm::scale, senza i prodotti 4x4)
+inline void ComposeTransformsScalar(TransformSoA const &trs, size_t begin, size_t end, glm::mat4 *out) {
+    for (size_t i = begin; i < end; i++) {
+        float x = trs.qx[i], y = trs.qy[i], z = trs.qz[i], w = trs.qw[i];
+        float xx = x * x, yy = y * y, zz = z * z, xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+        glm::mat4 &m = out[i];
+        m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * trs.sx[i], 2.0f * (xy + wz) * trs.sx[i], 2.0f * (xz - wy) * trs.sx[i], 0.0f);
+        m[1] = glm::vec4(2.0f * (xy - wz) * trs.sy[i], (1.0f - 2.0f * (xx + zz)) * trs.sy[i], 2.0f * (yz + wx) * trs.sy[i], 0.0f);
+        m[2] = glm::vec4(2.0f * (xz + wy) * trs.sz[i], 2.0f * (yz - wx) * trs.sz[i], (1.0f - 2.0f * (xx + yy)) * trs.sz[i], 0.0f);
+        m[3] = glm::vec4(trs.px[i], trs.py[i], trs.pz[i], 1.0f);
+    }
+}
+
+// Box mondo (metodo di Arvo, come AABB::Transform) e, se richiesta, sfera
+// (centro del box, raggio = semidiagonale) in xyz + w
+inline void TransformBoundsScalar(glm::mat4 const *matrices, AABB const *local, size_t begin, size_t end,
+                                  AABB *world, glm::vec4 *spheres) {
+    for (size_t i = begin; i < end; i++) {
+        world[i] = local[i].Transform(matrices[i]);
+        if (spheres)
+            spheres[i] = glm::vec4(world[i].Center(), glm::length(world[i].Extents()));
+    }
+}
+
+// --- PERCORSI SIMD ---
+#if defined(TRANSFORM_KERNEL_AVX2) || defined(TRANSFORM_KERNEL_SSE)
+
+// Scrive le colonne 'column' di 4 matrici: a/b/c/d sono le componenti x/y/z/w
+// della colonna, un oggetto per lane (trasposizione 4x4)
+inline void StoreColumns4(glm::mat4 *out, int column, __m128 a, __m128 b, __m128 c, __m128 d) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(&out[0][column][0], a);
+    _mm_storeu_ps(&out[1][column][0], b);
+    _mm_storeu_ps(&out[2][column][0], c);
+    _mm_storeu_ps(&out[3][column][0], d);
+}
+
+inline void StoreBounds(__m128 center, __m128 extents, AABB &world, glm::vec4 *sphere) {
+    alignas(16) float minimum[4], maximum[4];
+    _mm_store_ps(minimum, _mm_sub_ps(center, extents));
+    _mm_store_ps(maximum, _mm_add_ps(center, extents));
+    world.Min = glm::vec3(minimum[0], minimum[1], minimum[2]);
+    world.Max = glm::vec3(maximum[0], maximum[1], maximum[2]);
+    if (sphere) {
+        alignas(16) float c[4], e[4];
+        _mm_store_ps(c, center);
+        _mm_store_ps(e, extents);
+        *sphere = glm::vec4(c[0], c[1], c[2], std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]));
+    }
+}
+
+#endif
+
+#if defined(TRANSFORM_KERNEL_AVX2)
+
+inline void ComposeTransforms(TransformSoA const &trs, size_t begin, size_t end, glm::mat4 *out) {
+    const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&trs.qx[i]), y = _mm256_loadu_ps(&trs.qy[i]);
+        __m256 z = _mm256_loadu_ps(&trs.qz[i]), w = _mm256_loadu_ps(&trs.qw[i]);
+        __m256 sx = _mm256_loadu_ps(&trs.sx[i]), sy = _mm256_loadu_ps(&trs.sy[i]), sz = _mm256_loadu_ps(&trs.sz[i]);
+        __m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+        __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+        __m256 columns[4][4] = {
+            { _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+              _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero },
+            { _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+              _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero },
+            { _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+              _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero },
+            { _mm256_loadu_ps(&trs.px[i]), _mm256_loadu_ps(&trs.py[i]), _mm256_loadu_ps(&trs.pz[i]), one },
+        };
+        // Le trasposizioni lavorano su 4 lane: metà bassa oggetti 0-3, alta 4-7
+        for (int c = 0; c < 4; c++) {
+            StoreColumns4(&out[i], c, _mm256_castps256_ps128(columns[c][0]), _mm256_castps256_ps128(columns[c][1]),
+                          _mm256_castps256_ps128(columns[c][2]), _mm256_castps256_ps128(columns[c][3]));
+            StoreColumns4(&out[i + 4], c, _mm256_extractf128_ps(columns[c][0], 1), _mm256_extractf128_ps(columns[c][1], 1),
+                          _mm256_extractf128_ps(columns[c][2], 1), _mm256_extractf128_ps(columns[c][3], 1));
+        }
+    }
+    ComposeTransformsScalar(trs, i, end, out);
+}
+
+// Due oggetti per registro: lane 0-3 il primo, 4-7 il secondo
+inline void TransformBounds(glm::mat4 const *matrices, AABB const *local, size_t begin, size_t end,
+                            AABB *world, glm::vec4 *spheres) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+        glm::mat4 const &a = matrices[i], &b = matrices[i + 1];
+        glm::vec3 ca = local[i].Center(), cb = local[i + 1].Center();
+        glm::vec3 ea = local[i].Extents(), eb = local[i + 1].Extents();
+        __m256 c0 = _mm256_loadu2_m128(&b[0][0], &a[0][0]), c1 = _mm256_loadu2_m128(&b[1][0], &a[1][0]);
+        __m256 c2 = _mm256_loadu2_m128(&b[2][0], &a[2][0]), c3 = _mm256_loadu2_m128(&b[3][0], &a[3][0]);
+
+        __m256 center = _mm256_fmadd_ps(c0, _mm256_setr_m128(_mm_set1_ps(ca.x), _mm_set1_ps(cb.x)), c3);
+        center = _mm256_fmadd_ps(c1, _mm256_setr_m128(_mm_set1_ps(ca.y), _mm_set1_ps(cb.y)), center);
+        center = _mm256_fmadd_ps(c2, _mm256_setr_m128(_mm_set1_ps(ca.z), _mm_set1_ps(cb.z)), center);
+
+        __m256 extents = _mm256_mul_ps(_mm256_andnot_ps(signMask, c0), _mm256_setr_m128(_mm_set1_ps(ea.x), _mm_set1_ps(eb.x)));
+        extents = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, c1), _mm256_setr_m128(_mm_set1_ps(ea.y), _mm_set1_ps(eb.y)), extents);
+        extents = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, c2), _mm256_setr_m128(_mm_set1_ps(ea.z), _mm_set1_ps(eb.z)), extents);
+
+        StoreBounds(_mm256_castps256_ps128(center), _mm256_castps256_ps128(extents), world[i], spheres ? &spheres[i] : nullptr);
+        StoreBounds(_mm256_extractf128_ps(center, 1), _mm256_extractf128_ps(extents, 1), world[i + 1],
+                    spheres ? &spheres[i + 1] : nullptr);
+    }
+    TransformBoundsScalar(matrices, local, i, end, world, spheres);
+}
+
+#elif defined(TRANSFORM_KERNEL_SSE)
+
+inline void ComposeTransforms(TransformSoA const &trs, size_t begin, size_t end, glm::mat4 *out) {
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&trs.qx[i]), y = _mm_loadu_ps(&trs.qy[i]);
+        __m128 z = _mm_loadu_ps(&trs.qz[i]), w = _mm_loadu_ps(&trs.qw[i]);
+        __m128 sx = _mm_loadu_ps(&trs.sx[i]), sy = _mm_loadu_ps(&trs.sy[i]), sz = _mm_loadu_ps(&trs.sz[i]);
+        __m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+        __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+        __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+        __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+        StoreColumns4(&out[i], 0, _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+                      _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero);
+        StoreColumns4(&out[i], 1, _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                      _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero);
+        StoreColumns4(&out[i], 2, _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                      _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero);
+        StoreColumns4(&out[i], 3, _mm_loadu_ps(&trs.px[i]), _mm_loadu_ps(&trs.py[i]), _mm_loadu_ps(&trs.pz[i]), one);
+    }
+    ComposeTransformsScalar(trs, i, end, out);
+}
+
+// Un oggetto per registro: le colonne della matrice sono già vettori da 4
+inline void TransformBounds(glm::mat4 const *matrices, AABB const *local, size_t begin, size_t end,
+                            AABB *world, glm::vec4 *spheres) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (size_t i = begin; i < end; i++) {
+        glm::mat4 const &m = matrices[i];
+        glm::vec3 c = local[i].Center(), e = local[i].Extents();
+        __m128 c0 = _mm_loadu_ps(&m[0][0]), c1 = _mm_loadu_ps(&m[1][0]), c2 = _mm_loadu_ps(&m[2][0]), c3 = _mm_loadu_ps(&m[3][0]);
+        __m128 center = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(c.x)), _mm_mul_ps(c1, _mm_set1_ps(c.y))),
+                                   _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(c.z)), c3));
+        __m128 extents = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, c0), _mm_set1_ps(e.x)),
+                                               _mm_mul_ps(_mm_andnot_ps(signMask, c1), _mm_set1_ps(e.y))),
+                                    _mm_mul_ps(_mm_andnot_ps(signMask, c2), _mm_set1_ps(e.z)));
+        StoreBounds(center, extents, world[i], spheres ? &spheres[i] : nullptr);
+    }
+}
+
+#else
+
+inline void ComposeTransforms(TransformSoA const &trs, size_t begin, size_t end, glm::mat4 *out) {
+    ComposeTransformsScalar(trs, begin, end, out);
+}
+
+inline void TransformBounds(glm::mat4 const *matrices, AABB const *local, size_t begin, size_t end,
+                            AABB *world, glm::vec4 *spheres) {
+    TransformBoundsScalar(matrices, local, begin, end, world, spheres);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef VIRTUAL_FILE_SYSTEM_H
+#define VIRTUAL_FILE_SYSTEM_H
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+#include "PackFile.h"
+#include "CpuTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Contenuto di un file letto dal VFS: punta nella mappa dell'archivio (entry
+// non compresse, zero copie) oppure in un buffer proprio (entry compresse o
+// file letti da disco), che vive finché vive la vista
+struct FileView {
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<std::vector<unsigned char>> owned;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+// Contatori del VFS (atomici: si legge dai job di caricamento)
+struct VfsStats {
+    std::atomic<unsigned long> lookups{ 0 };        // richieste al VFS
+    std::atomic<unsigned long> packHits{ 0 };       // trovate nell'archivio
+    std::atomic<unsigned long> diskReads{ 0 };      // non nell'archivio: lette da disco
+    std::atomic<unsigned long long> mappedBytes{ 0 };       // servite dalla mappa senza copie
+    std::atomic<unsigned long long> decompressedBytes{ 0 }; // decompresse in un buffer
+};
+
+// --- FILE SYSTEM VIRTUALE ---
+// Con un archivio montato, i percorsi sotto la radice di montaggio (es.
+// PROJECT_ROOT/assets) diventano chiavi dell'archivio: una ricerca nella
+// tabella hash in memoria al posto di open/stat sul disco per ogni tentativo.
+// Se un file manca dall'archivio (o nessun archivio è montato) si legge dal
+// disco come prima, quindi gli asset nuovi funzionano anche senza ricostruirlo.
+class VirtualFileSystem {
+public:
+    VfsStats stats;
+
+    bool Mount(std::string const &packPath, std::string const &root) {
+        CPU_ZONE("VirtualFileSystem::Mount");
+        if (!pack.Open(packPath))
+            return false;
+        this->root = Normalize(root);
+        if (!this->root.empty() && this->root.back() != '/')
+            this->root += '/';
+        return true;
+    }
+
+    bool Mounted() const { return pack.IsOpen(); }
+    PackFile const &Pack() const { return pack; }
+
+    // Chiave nell'archivio del percorso: relativa alla radice, con '/'
+    std::string Key(std::string const &path) const {
+        std::string key = Normalize(path);
+        if (!root.empty() && key.compare(0, root.size(), root) == 0)
+            key.erase(0, root.size());
+        return key;
+    }
+
+    PackEntry const *Find(std::string const &path) const { return pack.IsOpen() ? pack.Find(Key(path)) : nullptr; }
+
+    bool Exists(std::string const &path) const {
+        if (Find(path))
+            return true;
+        std::ifstream file(path, std::ios::binary);
+        return (bool)file;
+    }
+
+    // Solo dall'archivio: vista vuota se il file non c'è
+    FileView ReadPacked(std::string const &path) {
+        FileView view;
+        stats.lookups++;
+        PackEntry const *entry = Find(path);
+        if (!entry)
+            return view;
+        stats.packHits++;
+        if (const unsigned char *data = pack.Data(*entry)) {
+            view.data = data;
+            view.size = entry->size;
+            stats.mappedBytes += entry->size;
+            return view;
+        }
+        view.owned = std::make_shared<std::vector<unsigned char>>();
+        if (!pack.Read(*entry, *view.owned))
+            return FileView();
+        view.data = view.owned->data();
+        view.size = view.owned->size();
+        stats.decompressedBytes += view.size;
+        return view;
+    }
+
+    // Dall'archivio se c'è, altrimenti dal disco; vista vuota se non esiste
+    FileView Read(std::string const &path) {
+        FileView view = ReadPacked(path);
+        if (view)
+            return view;
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return view;
+        stats.diskReads++;
+        view.owned = std::make_shared<std::vector<unsigned char>>((size_t)file.tellg());
+        file.seekg(0);
+        file.read((char *)view.owned->data(), view.owned->size());
+        // data non nullo anche per un file vuoto: la vista esiste
+        static const unsigned char empty = 0;
+        view.data = view.owned->empty() ? &empty : view.owned->data();
+        view.size = view.owned->size();
+        return view;
+    }
+
+    static std::string Normalize(std::string path) {
+        std::replace(path.begin(), path.end(), '\\', '/');
+        std::string out;
+        out.reserve(path.size());
+        for (size_t i = 0; i < path.size(); i++) {
+            if (path[i] == '/' && !out.empty() && out.back() == '/')
+                continue; // "a//b" -> "a/b"
+            if (path.compare(i, 2, "./") == 0 && (out.empty() || out.back() == '/')) {
+                i++;      // "a/./b" -> "a/b"
+                continue;
+            }
+            out += path[i];
+        }
+        return out;
+    }
+
+private:
+    PackFile pack;
+    std::string root;
+};
+
+// Istanza globale, montata in main prima del caricamento dei modelli
+inline VirtualFileSystem vfs;
+
+// --- ADATTATORE PER ASSIMP ---
+// Assimp apre .obj e .mtl attraverso questo IOSystem: le letture vanno alla
+// vista del VFS (nella mappa dell'archivio, o il file letto da disco)
+class VfsIOStream : public Assimp::IOStream {
+public:
+    explicit VfsIOStream(FileView view) : view(std::move(view)) {}
+
+    size_t Read(void *buffer, size_t size, size_t count) override {
+        if (size == 0)
+            return 0;
+        size_t items = std::min(count, (view.size - position) / size);
+        std::memcpy(buffer, view.data + position, items * size);
+        position += items * size;
+        return items;
+    }
+
+    size_t Write(const void *, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override {
+        size_t base = origin == aiOrigin_SET ? 0 : origin == aiOrigin_CUR ? position : view.size;
+        if (base + offset > view.size)
+            return aiReturn_FAILURE;
+        position = base + offset;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return position; }
+    size_t FileSize() const override { return view.size; }
+    void Flush() override {}
+
+private:
+    FileView view;
+    size_t position = 0;
+};
+
+class VfsIOSystem : public Assimp::IOSystem {
+public:
+    bool Exists(const char *path) const override { return vfs.Exists(path); }
+    char getOsSeparator() const override { return '/'; }
+
+    Assimp::IOStream *Open(const char *path, const char *mode = "rb") override {
+        if (std::strchr(mode, 'w') || std::strchr(mode, 'a'))
+            return nullptr; // in sola lettura
+        FileView view = vfs.Read(path);
+        return view ? new VfsIOStream(std::move(view)) : nullptr;
+    }
+
+    void Close(Assimp::IOStream *stream) override { delete stream; }
+};
+
+#endif
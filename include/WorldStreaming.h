@@ -0,0 +1,563 @@
+#ifndef WORLD_STREAMING_H
+#define WORLD_STREAMING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "CameraPredictor.h"
+#include "Scatter.h"
+#include "Scene.h"
+#include "ShaderCache.h" // Hash
+#include "ShaderLibrary.h"
+#include "Terrain.h"
+#include "CpuTrace.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+// Una cella della partizione del mondo: le istanze dei layer nelle sue tile e
+// i modelli da cui dipendono. Non cambia più dopo il caricamento, quindi la
+// condividono job, thread principale e render thread tramite shared_ptr.
+struct WorldCell {
+    int x = 0, z = 0;
+    std::vector<ScatterInstances> sets;    // uno per layer, senza buffer GL
+    std::vector<std::string> dependencies; // directory dei modelli usati dalla cella
+    AABB bounds;
+    size_t bytes = 0;                      // istanze in memoria (la stessa quantità in VRAM)
+    bool fromDisk = false;
+};
+
+struct WorldStreamingStats {
+    unsigned int resident = 0, loading = 0;
+    size_t residentBytes = 0;
+    unsigned long long loads = 0, unloads = 0;
+    unsigned long long diskHits = 0, generated = 0; // celle lette dalla cache / generate e scritte
+    unsigned long long budgetEvictions = 0;         // scaricate prima dell'isteresi per stare nel budget
+    unsigned long long budgetDeferred = 0;          // caricamenti rimandati a budget pieno
+    // Celle entrate nel raggio di disegno già residenti (hit) o non ancora (miss)
+    unsigned long long hits = 0, misses = 0;
+    // Caricate solo per la predizione: poi servite davvero, o scaricate senza servire
+    unsigned long long prefetched = 0, prefetchHits = 0, prefetchWasted = 0;
+
+    double HitRate() const { return hits + misses ? (double)hits / (double)(hits + misses) : 1.0; }
+};
+
+// --- STREAMING DEL MONDO A CELLE ---
+// Il terreno è diviso in celle di cellTiles x cellTiles tile dello scatter.
+// Le celle entro loadRadius dalla camera (distanza sul piano XZ dal loro
+// rettangolo) si caricano sui job; quelle oltre unloadRadius si scaricano, e
+// la fascia in mezzo evita che una camera sul bordo le carichi e scarichi di
+// continuo. Se le celle residenti superano memoryBudget si scaricano prima
+// quelle della fascia, dalla più lontana; se non basta i nuovi caricamenti
+// aspettano. Ogni cella sta in <directory>/cell_<x>_<z>.bin: alla prima visita
+// si genera (Scatter::GenerateRegion, identica allo scatter del terreno intero)
+// e si scrive, poi si rilegge da disco. Il mondo è limitato dal disco, non
+// dalla RAM o dalla VRAM.
+// Update() va chiamato solo dal thread principale; il render thread riceve le
+// celle residenti con l'istantanea del frame e le carica con WorldCellBuffers.
+class WorldStreamer {
+public:
+    int cellTiles = 4;                // tile dello scatter per lato (4 x 64 m = 256 m)
+    float loadRadius = 320.0f;
+    float unloadRadius = 448.0f;
+    size_t memoryBudget = 16u << 20; // byte di istanze residenti
+    unsigned int maxLoadsInFlight = 4;
+    float prefetchSeconds = 3.0f;     // anticipo della predizione della camera
+    std::string directory;
+    WorldStreamingStats stats;
+
+    WorldStreamer(std::string const &directory) : directory(directory) {}
+    ~WorldStreamer() { jobs.Wait(inFlight); }
+
+    // 'source' distingue i terreni con lo stesso seed (es. il percorso della heightmap)
+    void Create(Terrain const &terrain, Scatter const &scatter, std::vector<ScatterLayer> const &layers,
+                unsigned int seed, std::string const &source) {
+        this->terrain = &terrain;
+        this->scatter = &scatter;
+        this->layers = layers;
+        this->seed = seed;
+        tilesPerSide = scatter.TilesPerSide(terrain);
+        cellsPerSide = (tilesPerSide + cellTiles - 1) / cellTiles;
+        cellSize = cellTiles * scatter.tileSize;
+        origin = -0.5f * terrain.size;
+
+        // Chiave delle celle su disco: se cambia qualcosa che le genera, si rigenerano
+        key = ShaderCache::Hash(&seed, sizeof(seed));
+        key = ShaderCache::Hash(source.data(), source.size(), key);
+        float shape[4] = { terrain.size, terrain.heightScale, scatter.tileSize, (float)cellTiles };
+        key = ShaderCache::Hash(shape, sizeof(shape), key);
+        for (ScatterLayer const &layer : layers) {
+            key = ShaderCache::Hash(layer.name, std::strlen(layer.name) + 1, key);
+            float rules[8] = { layer.minDistance, layer.maxSlope, layer.minHeight, layer.maxHeight,
+                               layer.minScale, layer.maxScale, layer.alignToNormal, layer.sink };
+            key = ShaderCache::Hash(rules, sizeof(rules), key);
+        }
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error)
+            std::cout << "ERRORE::STREAMING::DIRECTORY " << directory << ": " << error.message() << std::endl;
+    }
+
+    // Genera su disco le celle che mancano (--bake-world), in parallelo
+    void Bake() {
+        CPU_ZONE("WorldStreamer::Bake");
+        jobs.ParallelFor((size_t)cellsPerSide * cellsPerSide, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                WorldCell cell;
+                cell.x = (int)(c % cellsPerSide);
+                cell.z = (int)(c / cellsPerSide);
+                if (!Read(cell))
+                    Write(Generate(cell));
+            }
+        });
+    }
+
+    // Avvia i caricamenti e applica scaricamenti e budget. 'wait' completa i
+    // caricamenti prima di ritornare (frame riproducibili: headless e golden).
+    // Le celle attorno alla posizione predetta fra prefetchSeconds si caricano
+    // in anticipo, e tra quelle mancanti passano prima quelle nella direzione
+    // di vista predetta.
+    void Update(CameraPredictor const &camera, bool wait = false) {
+        CPU_ZONE("WorldStreamer::Update");
+        position = camera.Position();
+        predicted = camera.PredictPosition(prefetchSeconds);
+        front = camera.PredictFront(0.5f * prefetchSeconds);
+        Collect();
+
+        for (auto it = slots.begin(); it != slots.end();) {
+            Slot &slot = it->second;
+            if (slot.cell && Nearest(slot.cell->x, slot.cell->z) > unloadRadius) {
+                Unload(slot);
+                stats.unloads++;
+                it = slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // Celle mancanti entro il raggio della camera o della sua predizione
+        std::vector<std::pair<float, int>> wanted;
+        glm::vec3 low = glm::min(position, predicted) - glm::vec3(loadRadius);
+        glm::vec3 high = glm::max(position, predicted) + glm::vec3(loadRadius);
+        for (int z = CellIndex(low.z); z <= CellIndex(high.z); z++)
+            for (int x = CellIndex(low.x); x <= CellIndex(high.x); x++)
+                if (Nearest(x, z) <= loadRadius && !slots.count(z * cellsPerSide + x))
+                    wanted.push_back({ Priority(x, z), z * cellsPerSide + x });
+        std::sort(wanted.begin(), wanted.end());
+
+        unsigned int limit = wait ? UINT_MAX : maxLoadsInFlight;
+        for (auto const &w : wanted) {
+            if (loading >= limit)
+                break;
+            // Stima delle celle in arrivo dalla media di quelle residenti
+            size_t estimate = (stats.resident ? stats.residentBytes / stats.resident : 0) * (loading + 1);
+            while (stats.residentBytes + estimate > memoryBudget && Evict(w.first, false)) {}
+            if (stats.residentBytes + estimate > memoryBudget) {
+                stats.budgetDeferred++;
+                break;
+            }
+            int x = w.second % cellsPerSide, z = w.second / cellsPerSide;
+            Load(x, z, Distance(x, z, position) > loadRadius);
+        }
+
+        // Con un solo thread i job partono solo quando qualcuno attende
+        if (wait || jobs.ThreadCount() == 1) {
+            jobs.Wait(inFlight);
+            Collect();
+        }
+        CountNeeded();
+
+        stats.resident = 0;
+        for (auto const &slot : slots)
+            stats.resident += slot.second.cell ? 1 : 0;
+        stats.loading = loading;
+    }
+
+    // Celle residenti, da copiare nell'istantanea del frame: prima le più
+    // urgenti, così il render thread le carica in VRAM in quest'ordine
+    std::vector<std::shared_ptr<const WorldCell>> Resident() const {
+        std::vector<std::pair<float, std::shared_ptr<const WorldCell>>> sorted;
+        sorted.reserve(slots.size());
+        for (auto const &slot : slots)
+            if (slot.second.cell)
+                sorted.push_back({ Priority(slot.second.cell->x, slot.second.cell->z), slot.second.cell });
+        std::sort(sorted.begin(), sorted.end(),
+                  [](auto const &a, auto const &b) { return a.first < b.first; });
+        std::vector<std::shared_ptr<const WorldCell>> cells;
+        cells.reserve(sorted.size());
+        for (auto &entry : sorted)
+            cells.push_back(std::move(entry.second));
+        return cells;
+    }
+
+    int CellsPerSide() const { return cellsPerSide; }
+
+    // Distanza sul piano XZ tra 'point' e il rettangolo della cella (x, z)
+    float Distance(int x, int z, glm::vec3 const &point) const {
+        float minX = origin + x * cellSize, minZ = origin + z * cellSize;
+        float dx = std::max(std::max(minX - point.x, point.x - (minX + cellSize)), 0.0f);
+        float dz = std::max(std::max(minZ - point.z, point.z - (minZ + cellSize)), 0.0f);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<const WorldCell> cell; // nullptr = in caricamento
+        bool prefetched = false;               // chiesta solo per la predizione
+        bool needed = false;                   // è già entrata nel raggio di disegno
+    };
+
+    // Intestazione di un file di cella, seguita per ogni layer da tile, istanze,
+    // tileStart, tileBounds e matrici
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        int32_t x, z;
+        uint32_t layers;
+    };
+    static constexpr uint32_t MAGIC   = 0x4C435746; // "FWCL"
+    static constexpr uint32_t VERSION = 1;
+
+    Terrain const *terrain = nullptr;
+    Scatter const *scatter = nullptr;
+    std::vector<ScatterLayer> layers;
+    unsigned int seed = 0;
+    uint64_t key = 0;
+    int tilesPerSide = 1, cellsPerSide = 1;
+    float cellSize = 256.0f, origin = 0.0f;
+
+    // Camera dell'ultimo Update: posizione, posizione e direzione predette
+    glm::vec3 position = glm::vec3(0.0f), predicted = glm::vec3(0.0f), front = glm::vec3(0.0f, 0.0f, -1.0f);
+
+    std::unordered_map<int, Slot> slots; // indice z * cellsPerSide + x
+    std::vector<int> needed;             // celle nel raggio di disegno all'ultimo Update
+    unsigned int loading = 0;
+    JobCounter inFlight;
+    std::mutex completedMutex;
+    std::vector<std::shared_ptr<WorldCell>> completed;
+
+    int CellIndex(float coordinate) const {
+        return std::min(std::max((int)std::floor((coordinate - origin) / cellSize), 0), cellsPerSide - 1);
+    }
+
+    // Distanza dalla camera o dalla sua predizione, la minore
+    float Nearest(int x, int z) const { return std::min(Distance(x, z, position), Distance(x, z, predicted)); }
+
+    // Urgenza di una cella (minore = prima): distanza dal percorso predetto,
+    // dimezzata per le celle davanti alla direzione di vista predetta
+    float Priority(int x, int z) const {
+        glm::vec2 toCell(origin + (x + 0.5f) * cellSize - position.x, origin + (z + 0.5f) * cellSize - position.z);
+        glm::vec2 view(front.x, front.z);
+        float facing = glm::dot(toCell, toCell) > 1e-4f && glm::dot(view, view) > 1e-4f
+                           ? glm::dot(glm::normalize(toCell), glm::normalize(view)) : 0.0f;
+        return Nearest(x, z) * (1.0f - 0.5f * std::max(facing, 0.0f));
+    }
+
+    void Load(int x, int z, bool prefetch) {
+        Slot &slot = slots[z * cellsPerSide + x];
+        slot = Slot();
+        slot.prefetched = prefetch;
+        stats.prefetched += prefetch ? 1 : 0;
+        loading++;
+        jobs.Run([this, x, z]() {
+            CPU_ZONE("WorldStreamer::Load");
+            auto cell = std::make_shared<WorldCell>();
+            cell->x = x;
+            cell->z = z;
+            if (!Read(*cell))
+                Write(Generate(*cell));
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(cell);
+        }, &inFlight);
+    }
+
+    void Unload(Slot const &slot) {
+        if (slot.cell) {
+            stats.residentBytes -= slot.cell->bytes;
+            stats.resident--;
+        }
+        if (slot.prefetched && !slot.needed)
+            stats.prefetchWasted++;
+    }
+
+    // Celle finite dai job: residenti, se nel frattempo la camera non si è allontanata
+    void Collect() {
+        std::vector<std::shared_ptr<WorldCell>> done;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            done.swap(completed);
+        }
+        for (auto &cell : done) {
+            loading--;
+            int index = cell->z * cellsPerSide + cell->x;
+            if (Nearest(cell->x, cell->z) > unloadRadius) {
+                Unload(slots[index]);
+                slots.erase(index);
+                continue;
+            }
+            slots[index].cell = cell;
+            stats.residentBytes += cell->bytes;
+            stats.loads++;
+            (cell->fromDisk ? stats.diskHits : stats.generated)++;
+            stats.resident++;
+        }
+        // Prima la fascia di isteresi, poi anche celle nel raggio: il budget è un limite
+        while (stats.residentBytes > memoryBudget && Evict(-1.0f, true)) {}
+        while (stats.residentBytes > memoryBudget && Evict(-1.0f, false)) {}
+    }
+
+    // Scarica la cella residente meno urgente con priorità oltre 'priority'
+    // (solo fuori dal raggio di caricamento se 'outside'); falso se non ce n'è
+    bool Evict(float priority, bool outside) {
+        auto victim = slots.end();
+        float worst = priority;
+        for (auto it = slots.begin(); it != slots.end(); ++it) {
+            Slot const &slot = it->second;
+            if (!slot.cell || (outside && Nearest(slot.cell->x, slot.cell->z) <= loadRadius))
+                continue;
+            float p = Priority(slot.cell->x, slot.cell->z);
+            if (p > worst) {
+                worst = p;
+                victim = it;
+            }
+        }
+        if (victim == slots.end())
+            return false;
+        Unload(victim->second);
+        stats.budgetEvictions++;
+        slots.erase(victim);
+        return true;
+    }
+
+    // Celle appena entrate nel raggio di disegno: hit se erano già residenti
+    void CountNeeded() {
+        float radius = scatter->drawDistance;
+        std::vector<int> now;
+        for (int z = CellIndex(position.z - radius); z <= CellIndex(position.z + radius); z++)
+            for (int x = CellIndex(position.x - radius); x <= CellIndex(position.x + radius); x++)
+                if (Distance(x, z, position) <= radius)
+                    now.push_back(z * cellsPerSide + x);
+        for (int index : now) {
+            if (std::find(needed.begin(), needed.end(), index) != needed.end())
+                continue;
+            auto it = slots.find(index);
+            bool resident = it != slots.end() && it->second.cell;
+            (resident ? stats.hits : stats.misses)++;
+            if (it == slots.end())
+                continue;
+            if (it->second.prefetched && !it->second.needed)
+                stats.prefetchHits++;
+            it->second.needed = true;
+        }
+        needed.swap(now);
+    }
+
+    // Solo CPU e senza stato condiviso: gira su qualsiasi job
+    WorldCell &Generate(WorldCell &cell) const {
+        ScatterRegion region = { cell.x * cellTiles, cell.z * cellTiles, std::min((cell.x + 1) * cellTiles, tilesPerSide),
+                                 std::min((cell.z + 1) * cellTiles, tilesPerSide) };
+        cell.sets = scatter->GenerateRegion(*terrain, layers, seed, region);
+        cell.fromDisk = false;
+        Finish(cell);
+        return cell;
+    }
+
+    void Finish(WorldCell &cell) const {
+        cell.bytes = 0;
+        cell.bounds = AABB();
+        cell.dependencies.clear();
+        for (size_t l = 0; l < cell.sets.size(); l++) {
+            ScatterInstances &set = cell.sets[l];
+            set.model = layers[l].model;
+            set.name = layers[l].name;
+            cell.bytes += set.matrices.size() * sizeof(glm::mat4) + set.tileBounds.size() * sizeof(AABB) +
+                          set.tileStart.size() * sizeof(uint32_t);
+            for (AABB const &box : set.tileBounds)
+                if (box.Valid()) {
+                    cell.bounds.Expand(box.Min);
+                    cell.bounds.Expand(box.Max);
+                }
+            if (!set.matrices.empty() && set.model)
+                cell.dependencies.push_back(set.model->directory);
+        }
+    }
+
+    std::string PathFor(int x, int z) const {
+        char name[48];
+        std::snprintf(name, sizeof(name), "cell_%d_%d.bin", x, z);
+        return directory + "/" + name;
+    }
+
+    // Falso (cella da rigenerare) se il file manca, è di un'altra versione o è
+    // corrotto: i conteggi letti si controllano contro la dimensione del file
+    // prima di allocare, e gli inizi dei tile devono essere crescenti
+    bool Read(WorldCell &cell) const {
+        std::string path = PathFor(cell.x, cell.z);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        uint64_t remaining = (uint64_t)file.tellg();
+        file.seekg(0);
+        Header header;
+        if (remaining < sizeof(header) || !file.read((char *)&header, sizeof(header)))
+            return false;
+        remaining -= sizeof(header);
+        if (header.magic != MAGIC || header.version != VERSION || header.key != key || header.x != cell.x ||
+            header.z != cell.z || header.layers != layers.size())
+            return false;
+
+        cell.sets.assign(layers.size(), ScatterInstances());
+        for (ScatterInstances &set : cell.sets) {
+            uint32_t counts[2];
+            if (remaining < sizeof(counts) || !file.read((char *)counts, sizeof(counts)))
+                return Corrupt(cell, path);
+            remaining -= sizeof(counts);
+            uint64_t bytes = ((uint64_t)counts[0] + 1) * sizeof(uint32_t) + (uint64_t)counts[0] * sizeof(AABB) +
+                             (uint64_t)counts[1] * sizeof(glm::mat4);
+            if (counts[0] > (uint32_t)(cellTiles * cellTiles) || bytes > remaining)
+                return Corrupt(cell, path);
+            remaining -= bytes;
+            set.tileStart.resize(counts[0] + 1);
+            set.tileBounds.resize(counts[0]);
+            set.matrices.resize(counts[1]);
+            file.read((char *)set.tileStart.data(), set.tileStart.size() * sizeof(uint32_t));
+            file.read((char *)set.tileBounds.data(), set.tileBounds.size() * sizeof(AABB));
+            file.read((char *)set.matrices.data(), set.matrices.size() * sizeof(glm::mat4));
+            if (!file || set.tileStart.front() != 0 || set.tileStart.back() != counts[1] ||
+                !std::is_sorted(set.tileStart.begin(), set.tileStart.end()))
+                return Corrupt(cell, path);
+        }
+        cell.fromDisk = true;
+        Finish(cell);
+        return true;
+    }
+
+    // File illeggibile: come se mancasse, Load rigenera la cella e lo riscrive
+    bool Corrupt(WorldCell &cell, std::string const &path) const {
+        std::cout << "ERRORE::STREAMING::CELLA_CORROTTA " << path << std::endl;
+        cell.sets.clear();
+        return false;
+    }
+
+    // Scrive in un file temporaneo e poi rinomina: chi legge non vede mai una cella a metà
+    void Write(WorldCell const &cell) const {
+        std::string path = PathFor(cell.x, cell.z);
+        {
+            std::ofstream file(path + ".tmp", std::ios::binary);
+            if (!file) {
+                std::cout << "ERRORE::STREAMING::SCRITTURA " << path << std::endl;
+                return;
+            }
+            Header header = { MAGIC, VERSION, key, cell.x, cell.z, (uint32_t)cell.sets.size() };
+            file.write((const char *)&header, sizeof(header));
+            for (ScatterInstances const &set : cell.sets) {
+                uint32_t counts[2] = { (uint32_t)set.tileBounds.size(), (uint32_t)set.matrices.size() };
+                file.write((const char *)counts, sizeof(counts));
+                file.write((const char *)set.tileStart.data(), set.tileStart.size() * sizeof(uint32_t));
+                file.write((const char *)set.tileBounds.data(), set.tileBounds.size() * sizeof(AABB));
+                file.write((const char *)set.matrices.data(), set.matrices.size() * sizeof(glm::mat4));
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(path + ".tmp", path, error);
+        if (error)
+            std::cout << "ERRORE::STREAMING::SCRITTURA " << path << ": " << error.message() << std::endl;
+    }
+};
+
+// Lato GL dello streaming (render thread): un buffer di istanze per layer di
+// ogni cella ricevuta con il frame. Le celle nuove si caricano al massimo per
+// uploadBudget byte a frame, quelle sparite dall'istantanea si liberano.
+class WorldCellBuffers {
+public:
+    size_t uploadBudget = 4u << 20;
+    unsigned int cellsDrawn = 0;
+
+    void Sync(std::vector<std::shared_ptr<const WorldCell>> const &cells) {
+        CPU_ZONE("WorldCellBuffers::Sync");
+        for (auto &entry : gpuCells)
+            entry.second.seen = false;
+        size_t uploaded = 0;
+        for (auto const &cell : cells) {
+            auto it = gpuCells.find({ cell->z, cell->x });
+            if (it != gpuCells.end() && it->second.cell == cell) {
+                it->second.seen = true;
+                continue;
+            }
+            if (uploaded > 0 && uploaded + cell->bytes > uploadBudget)
+                continue;
+            if (it != gpuCells.end())
+                Release(it->second);
+            GpuCell &gpu = gpuCells[{ cell->z, cell->x }];
+            gpu.cell = cell;
+            gpu.seen = true;
+            for (ScatterInstances const &set : cell->sets)
+                gpu.buffers.push_back(Scatter::CreateInstanceBuffer(set.matrices));
+            uploaded += cell->bytes;
+        }
+        for (auto it = gpuCells.begin(); it != gpuCells.end();) {
+            if (it->second.seen) {
+                ++it;
+                continue;
+            }
+            Release(it->second);
+            it = gpuCells.erase(it);
+        }
+    }
+
+    // Celle in ordine fisso (z, x): stesso ordine di disegno a ogni frame
+    unsigned int Render(Scatter &scatter, ShaderLibrary &shaders, std::string const &family, glm::mat4 const &viewProjection,
+                        glm::vec3 const &cameraPosition, unsigned int features = 0, unsigned int mask = ~0u) {
+        CPU_ZONE("WorldCellBuffers::Render");
+        Frustum frustum(viewProjection);
+        unsigned int draws = 0;
+        cellsDrawn = 0;
+        for (auto const &entry : gpuCells) {
+            WorldCell const &cell = *entry.second.cell;
+            glm::vec3 d = glm::max(glm::max(cell.bounds.Min - cameraPosition, cameraPosition - cell.bounds.Max), glm::vec3(0.0f));
+            if (!cell.bounds.Valid() || glm::dot(d, d) > scatter.drawDistance * scatter.drawDistance ||
+                !frustum.Intersects(cell.bounds))
+                continue;
+            cellsDrawn++;
+            for (size_t l = 0; l < cell.sets.size(); l++)
+                draws += scatter.Render(cell.sets[l], entry.second.buffers[l], shaders, family, frustum, cameraPosition,
+                                        features, mask);
+        }
+        return draws;
+    }
+
+    size_t CellCount() const { return gpuCells.size(); }
+
+private:
+    struct GpuCell {
+        std::shared_ptr<const WorldCell> cell;
+        std::vector<unsigned int> buffers;
+        bool seen = false;
+    };
+
+    std::map<std::pair<int, int>, GpuCell> gpuCells;
+
+    static void Release(GpuCell &gpu) {
+        for (size_t l = 0; l < gpu.buffers.size(); l++)
+            Scatter::DeleteInstanceBuffer(gpu.buffers[l], gpu.cell->sets[l].matrices.size());
+        gpu.buffers.clear();
+    }
+};
+
+#endif
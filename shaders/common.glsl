@@ -0,0 +1,6 @@
+// Matrici di camera condivise da tutti i programmi (binding 0, aggiornate una volta per frame)
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
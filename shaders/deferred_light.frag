@@ -0,0 +1,29 @@
+#version 330 core
+#include "common.glsl"
+#include "lighting.glsl"
+#include "packing.glsl"
+
+// Pass di accumulo luci del percorso deferred: un fragment per pixel dello schermo,
+// le luci arrivano dalle liste per tile (stesso formato del clustered forward)
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 invViewProjection;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0)
+        discard; // cielo: resta il colore di clear
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(gDepth, 0));
+    vec4 world = invViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragPos = world.xyz / world.w;
+
+    vec3 N = DecodeNormal(texelFetch(gNormal, pixel, 0).xy);
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    FragColor = vec4(ComputeLighting(N, fragPos, albedo), 1.0);
+}
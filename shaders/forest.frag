@@ -0,0 +1,15 @@
+#version 330 core
+#include "common.glsl"
+#include "lighting.glsl"
+#include "surface.glsl"
+
+out vec4 FragColor;
+
+void main()
+{
+    vec4 texColor = texture(texture_diffuse1, TexCoords);
+#ifdef ALPHA_TEST
+    if (texColor.a < 0.1) discard; // Mantiene le foglie trasparenti
+#endif
+    FragColor = vec4(ComputeLighting(SurfaceNormal(), FragPos, texColor.rgb), texColor.a);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+#include "common.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 aTangent;
+#ifdef INSTANCED
+layout (location = 4) in mat4 aInstanceModel; // occupa le location 4..7
+#else
+uniform mat4 model;
+#endif
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+#ifdef NORMAL_MAP
+out vec3 Tangent;
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 world = aInstanceModel;
+#else
+    mat4 world = model;
+#endif
+    FragPos = vec3(world * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(world))) * aNormal;
+#ifdef NORMAL_MAP
+    Tangent = mat3(world) * aTangent;
+#endif
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+
+// Triangolo che copre tutto lo schermo, senza vertex buffer (glDrawArrays(GL_TRIANGLES, 0, 3))
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+#include "common.glsl"
+#include "surface.glsl"
+#include "packing.glsl"
+
+// G-buffer compatto: albedo RGBA8 + normale ottaedrica RG16 (posizione dalla profondità)
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec2 gNormal;
+
+void main()
+{
+    vec4 texColor = texture(texture_diffuse1, TexCoords);
+#ifdef ALPHA_TEST
+    if (texColor.a < 0.1) discard;
+#endif
+    gAlbedo = vec4(texColor.rgb, 1.0);
+    gNormal = EncodeNormal(SurfaceNormal());
+}
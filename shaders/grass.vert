@@ -0,0 +1,48 @@
+#version 330 core
+#include "common.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 4) in vec4 aInstance; // x, z, rotazione attorno a Y, scala
+
+uniform sampler2D heightmap;
+uniform vec4 terrainArea;    // come terrain.vert
+uniform float terrainBase;
+uniform vec3 grassDensity;   // distanza piena, distanza zero, scala del budget
+uniform float tileInstances; // ciuffi generati nella tile disegnata
+uniform float grassTime;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+
+float HeightAt(vec2 xz)
+{
+    float samples = float(textureSize(heightmap, 0).x);
+    vec2 uv = ((xz - terrainArea.xy) / terrainArea.z * (samples - 1.0) + 0.5) / samples;
+    return terrainBase + texture(heightmap, uv).r * terrainArea.w;
+}
+
+void main()
+{
+    vec3 root = vec3(aInstance.x, HeightAt(aInstance.xy), aInstance.y);
+
+    // Diradamento: le istanze sono in ordine casuale, il rango in [0, 1) decide
+    // a che distanza il ciuffo sparisce; si abbassa gradualmente invece di scattare
+    float rank = float(gl_InstanceID) / tileInstances;
+    float fraction = (1.0 - smoothstep(grassDensity.x, grassDensity.y, distance(root, viewPos.xyz))) * grassDensity.z;
+    float grow = clamp((fraction - rank) * 20.0, 0.0, 1.0);
+
+    float c = cos(aInstance.z), s = sin(aInstance.z);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+    vec3 local = rotation * (aPos * vec3(1.0, grow, 1.0) * aInstance.w);
+    // Vento: spostamento orizzontale che cresce col quadrato dell'altezza
+    float sway = sin(grassTime * 1.7 + root.x * 0.35 + root.z * 0.21) * 0.08 * aTexCoords.y * aTexCoords.y;
+    local.xz += vec2(sway, sway * 0.5) * aInstance.w;
+
+    FragPos = root + local;
+    Normal = rotation * aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
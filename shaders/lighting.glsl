@@ -0,0 +1,56 @@
+// --- ILLUMINAZIONE: sole direzionale + luci puntiformi con clustered forward ---
+// Le liste di luci per cluster le costruisce ClusteredLighting sulla CPU.
+layout (std140) uniform Lighting {
+    uvec4 clusterDims;   // tilesX, tilesY, slicesZ, numero luci
+    vec4  clusterParams; // scala e bias della fetta logaritmica, dimensione tile in pixel
+    vec4  sunDirection;  // direzione verso cui va la luce (world space)
+    vec4  sunColor;
+    vec4  ambientColor;
+};
+
+#ifdef SHADOW_RECEIVER
+#include "shadows.glsl"
+#endif
+
+uniform samplerBuffer  lightData;    // 2 texel per luce: (posizione, raggio), (colore * intensità)
+uniform usamplerBuffer clusterData;  // per cluster: (offset, conteggio)
+uniform usamplerBuffer lightIndices;
+
+uint ClusterIndex(vec3 fragPos)
+{
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    uint slice = uint(clamp(floor(log(depth) * clusterParams.x - clusterParams.y), 0.0, float(clusterDims.z - 1u)));
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / clusterParams.zw), clusterDims.xy - 1u);
+    return (slice * clusterDims.y + tile.y) * clusterDims.x + tile.x;
+}
+
+// Attenuazione fisica con finestra che arriva a zero esattamente al raggio
+float Attenuation(float distance, float radius)
+{
+    float ratio = distance / radius;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window / (distance * distance + 1.0);
+}
+
+vec3 ComputeLighting(vec3 N, vec3 fragPos, vec3 albedo)
+{
+    vec3 color = ambientColor.rgb * albedo;
+    float sun = max(dot(N, -sunDirection.xyz), 0.0);
+#ifdef SHADOW_RECEIVER
+    if (sun > 0.0)
+        sun *= SunShadow(fragPos, N);
+#endif
+    color += sun * sunColor.rgb * albedo;
+
+    uvec2 cluster = texelFetch(clusterData, int(ClusterIndex(fragPos))).xy;
+    for (uint i = 0u; i < cluster.y; i++) {
+        int light = int(texelFetch(lightIndices, int(cluster.x + i)).r);
+        vec4 posRadius = texelFetch(lightData, light * 2);
+        vec3 lightColor = texelFetch(lightData, light * 2 + 1).rgb;
+        vec3 L = posRadius.xyz - fragPos;
+        float distance = length(L);
+        float diffuse = max(dot(N, L / distance), 0.0);
+        color += diffuse * Attenuation(distance, posRadius.w) * lightColor * albedo;
+    }
+    return color;
+}
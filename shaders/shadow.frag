@@ -0,0 +1,15 @@
+#version 330 core
+
+in vec2 TexCoords;
+
+#ifdef ALPHA_TEST
+uniform sampler2D texture_diffuse1;
+#endif
+
+void main()
+{
+#ifdef ALPHA_TEST
+    // Le foglie proiettano l'ombra della loro sagoma, non del quad
+    if (texture(texture_diffuse1, TexCoords).a < 0.1) discard;
+#endif
+}
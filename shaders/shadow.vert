@@ -0,0 +1,24 @@
+#version 330 core
+#include "common.glsl"
+
+// Pass di profondità delle ombre: view/projection sono quelle della cascata
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+#ifdef INSTANCED
+layout (location = 4) in mat4 aInstanceModel;
+#else
+uniform mat4 model;
+#endif
+
+out vec2 TexCoords;
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 world = aInstanceModel;
+#else
+    mat4 world = model;
+#endif
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * world * vec4(aPos, 1.0);
+}
@@ -0,0 +1,31 @@
+// --- OMBRE DEL SOLE: cascaded shadow maps (vedi ShadowMaps.h) ---
+layout (std140) uniform Shadows {
+    mat4 cascadeMatrices[4];
+    vec4 cascadeSplits; // profondità di vista a cui finisce ogni cascata
+    vec4 shadowParams;  // dimensione texel, bias
+    vec4 cascadeTexels; // lato di un texel in unità mondo, per cascata
+};
+
+uniform sampler2DArrayShadow shadowMap;
+
+// 1 = illuminato, 0 = in ombra. PCF 3x3 sopra il confronto lineare dell'hardware.
+float SunShadow(vec3 fragPos, vec3 N)
+{
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    if (depth >= cascadeSplits.w)
+        return 1.0;
+    int cascade = int(dot(vec4(greaterThanEqual(vec4(depth), cascadeSplits)), vec4(1.0)));
+
+    // Piccolo spostamento lungo la normale, proporzionale al texel della cascata
+    float texelWorld = cascadeTexels[cascade];
+    vec4 lightPos = cascadeMatrices[cascade] * vec4(fragPos + N * texelWorld * 1.5, 1.0);
+    vec3 coords = lightPos.xyz * 0.5 + 0.5;
+    if (coords.z > 1.0)
+        return 1.0;
+
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * shadowParams.x, float(cascade), coords.z - shadowParams.y));
+    return lit / 9.0;
+}
@@ -0,0 +1,29 @@
+// Ingressi del vertex shader "forest" e normale della superficie (forward e G-buffer)
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoords;
+#ifdef NORMAL_MAP
+in vec3 Tangent;
+uniform sampler2D texture_normal1;
+#endif
+
+uniform sampler2D texture_diffuse1;
+
+// Normale in world space (perturbata dalla normal map se la variante la usa)
+vec3 SurfaceNormal()
+{
+    vec3 N = normalize(Normal);
+#ifdef ALPHA_TEST
+    // Il fogliame è a doppia faccia: il retro usa la normale girata
+    if (!gl_FrontFacing) N = -N;
+#endif
+#ifdef NORMAL_MAP
+    vec3 T = normalize(Tangent - dot(Tangent, N) * N);
+    vec3 B = cross(N, T);
+    // Solo X e Y dalla texture (le normal map compresse in BC5 hanno due canali): Z è positiva in tangent space
+    vec2 xy = texture(texture_normal1, TexCoords).xy * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+    N = normalize(mat3(T, B, N) * tangentNormal);
+#endif
+    return N;
+}
@@ -0,0 +1,45 @@
+#version 330 core
+#include "common.glsl"
+
+// Griglia condivisa in [0, 1]^2: ogni draw la scala sul nodo del quadtree
+layout (location = 0) in vec2 aGrid;
+
+uniform sampler2D heightmap;
+uniform vec3 terrainNode;    // angolo x, z e lato del nodo
+uniform vec2 terrainMorph;   // distanze di inizio e fine del morph del livello
+uniform vec4 terrainArea;    // angolo x, z e lato del terreno, altezza massima
+uniform float terrainBase;
+uniform float gridSize;
+uniform float textureTiling;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+
+// Campioni agli angoli del terreno sui centri dei texel di bordo, come HeightAt() in C++
+float HeightAt(vec2 xz)
+{
+    float samples = float(textureSize(heightmap, 0).x);
+    vec2 uv = ((xz - terrainArea.xy) / terrainArea.z * (samples - 1.0) + 0.5) / samples;
+    return terrainBase + texture(heightmap, uv).r * terrainArea.w;
+}
+
+void main()
+{
+    vec2 xz = terrainNode.xy + aGrid * terrainNode.z;
+    float distance = length(vec3(xz.x, HeightAt(xz), xz.y) - viewPos.xyz);
+
+    // Geomorphing: i vertici dispari scivolano sul vicino pari, quindi con
+    // morph = 1 la griglia è quella del livello superiore
+    float morph = clamp((distance - terrainMorph.x) / (terrainMorph.y - terrainMorph.x), 0.0, 1.0);
+    xz -= fract(aGrid * gridSize * 0.5) * 2.0 / gridSize * terrainNode.z * morph;
+
+    float step = terrainArea.z / (float(textureSize(heightmap, 0).x) - 1.0);
+    float dx = HeightAt(xz + vec2(step, 0.0)) - HeightAt(xz - vec2(step, 0.0));
+    float dz = HeightAt(xz + vec2(0.0, step)) - HeightAt(xz - vec2(0.0, step));
+    Normal = normalize(vec3(-dx, 2.0 * step, -dz));
+
+    FragPos = vec3(xz.x, HeightAt(xz), xz.y);
+    TexCoords = xz * textureTiling;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
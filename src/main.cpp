@@ -9,152 +9,644 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "Camera.h"
 #include "Model.h"
+#include "GLExtensions.h"
+#include "ShaderCache.h"
+#include "ShaderLibrary.h"
+#include "ClusteredLighting.h"
+#include "ShadowMaps.h"
+#include "DeferredRenderer.h"
+#include "GpuProfiler.h"
+#include "HeadlessContext.h"
+#include "RenderTarget.h"
+#include "RenderStats.h"
+#include "CameraPath.h"
+#include "GoldenImage.h"
+#include "CpuTrace.h"
+#include "Scene.h"
+#include "DrawList.h"
+#include "EntityRegistry.h"
+#include "FrameQueue.h"
+#include "FixedTimestep.h"
+#include "Terrain.h"
+#include "Scatter.h"
+#include "Grass.h"
+#include "WorldStreaming.h"
+#include "CameraPredictor.h"
+#include "Benchmarks.h"
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 // --- SETUP CAMERA ---
 Camera camera(glm::vec3(0.0f, 3.0f, 15.0f));
 float lastX = 1920.0f / 2.0; 
 float lastY = 1080.0f / 2.0;
 bool firstMouse = true;
-float deltaTime = 0.0f;
+float deltaTime = 0.0f; // passo della simulazione (fisso, vedi FixedTimestep)
 float lastFrame = 0.0f;
 
+// --- PERCORSO DI RENDERING (--renderer all'avvio, F2 per cambiare) ---
+enum RenderPath { RENDER_FORWARD, RENDER_DEFERRED };
+RenderPath renderPath = RENDER_FORWARD;
+const char *renderPathNames[2] = { "FORWARD", "DEFERRED" };
+// Media mobile del tempo CPU di frame per ciascun percorso, per confrontarli sullo stesso giro
+double pathFrameMs[2] = { 0.0, 0.0 };
+// Dimensione del framebuffer vista dal thread principale (callback di GLFW)
+int framebufferWidth = 0, framebufferHeight = 0;
+
 // --- CALLBACKS ---
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow *window);
 
-// --- VERTEX SHADER ---
-const char *vertexShaderSource = "#version 330 core\n"
-    "layout (location = 0) in vec3 aPos;\n"
-    "layout (location = 1) in vec3 aNormal;\n" 
-    "layout (location = 2) in vec2 aTexCoords;\n"
-    "out vec3 Normal;\n"
-    "out vec3 FragPos;\n"
-    "out vec2 TexCoords;\n"
-    "uniform mat4 model;\n"
-    "uniform mat4 view;\n"
-    "uniform mat4 projection;\n"
-    "void main()\n"
-    "{\n"
-    "   FragPos = vec3(model * vec4(aPos, 1.0));\n"
-    "   Normal = mat3(transpose(inverse(model))) * aNormal;\n"
-    "   TexCoords = aTexCoords;\n"
-    "   gl_Position = projection * view * vec4(FragPos, 1.0);\n"
-    "}\0";
-
-// --- FRAGMENT SHADER (SISTEMATO) ---
-const char *fragmentShaderSource = "#version 330 core\n"
-    "out vec4 FragColor;\n"
-    "in vec3 Normal;\n"
-    "in vec3 FragPos;\n"
-    "in vec2 TexCoords;\n"
-    
-    "uniform sampler2D texture_diffuse1;\n"
-
-    "void main()\n"
-    "{\n"
-    "   vec4 texColor = texture(texture_diffuse1, TexCoords);\n"
-    
-    // --- DEBUG TEXTURE ---
-    // Mostriamo SOLO il colore dell'immagine caricata.
-    // Niente luci, niente ombre, niente calcoli.
-    
-    "   if(texColor.a < 0.1) discard;\n" // Mantiene le foglie trasparenti
-    "   FragColor = texColor;\n"
-    "}\n\0";
-int main() {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
-    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Foresta 3D Finale", primaryMonitor, NULL);
-    if (window == NULL) { glfwTerminate(); return -1; }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return -1;
+// --- LUCI DELLA SCENA ---
+// Un fuoco da campo, qualche lanterna e uno sciame di lucciole (seed fisso)
+std::vector<PointLight> createSceneLights(unsigned int fireflies, unsigned int seed) {
+    std::vector<PointLight> lights;
+    lights.push_back({ glm::vec3(1.5f, -1.5f, -3.0f), 8.0f, glm::vec3(1.0f, 0.5f, 0.15f), 6.0f });
+    lights.push_back({ glm::vec3(-4.0f, 0.0f, -8.0f), 6.0f, glm::vec3(1.0f, 0.8f, 0.5f), 3.0f });
+    lights.push_back({ glm::vec3(6.0f, 0.0f, 2.0f), 6.0f, glm::vec3(1.0f, 0.8f, 0.5f), 3.0f });
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> xz(-40.0f, 40.0f), height(-1.5f, 3.0f);
+    for (unsigned int i = 0; i < fireflies; i++)
+        lights.push_back({ glm::vec3(xz(rng), height(rng), xz(rng)), 2.5f, glm::vec3(0.7f, 1.0f, 0.3f), 1.5f });
+    return lights;
+}
+
+// --- OPZIONI DA RIGA DI COMANDO ---
+struct Options {
+    bool headless = false;     // contesto offscreen (EGL/OSMesa), niente finestra
+    int width = 1280, height = 720; // risoluzione del rendering headless
+    unsigned int frames = 300; // frame da disegnare in headless
+    std::string output;        // se non vuoto: ultimo frame headless salvato in PPM
+    std::string benchmark;     // se non vuoto: volo scriptato con risultati JSON in questo file
+    std::string cameraPath;    // percorso registrato (F3); vuoto = giro predefinito
+    unsigned int seed = 7;     // seed della scena (lucciole)
+    std::string golden;        // file di budget: confronto con le immagini golden (implica headless)
+    bool updateGolden = false; // riscrive le golden invece di confrontarle
+    RenderPath renderPath = RENDER_FORWARD; // --renderer forward|deferred (poi F2 nella finestra)
+    std::string trace;         // se non vuoto: zone CPU esportate in formato Chrome trace
+    std::string stats;         // se non vuoto: contatori del frame in CSV o JSON (dall'estensione)
+    unsigned int statsEvery = 60; // un campione dei contatori ogni N frame
+    std::string heightmap;     // PNG a 16 bit del terreno; vuoto = procedurale dal seed
+    bool bakeWorld = false;    // genera su disco tutte le celle del mondo prima di partire
+    std::string pack;          // archivio degli asset (pack_builder); vuoto = assets.pack se c'è
+    bool compressTextures = true; // texture in formati a blocchi BC, con la cache in texture_cache/
+};
+
+// File della traccia CPU (--trace), scritto da finishTrace() in fondo a main
+std::string traceOutput;
+
+// Chiude la traccia CPU: smette di registrare e ferma i worker del job system
+// prima di scrivere il file, così nessun thread tocca i buffer durante l'export.
+// Il thread di rendering va unito prima di chiamarla.
+void finishTrace() {
+    if (traceOutput.empty())
+        return;
+    CPU_TRACE_STOP();
+    jobs.Stop();
+    CPU_TRACE_EXPORT(traceOutput);
+    traceOutput.clear();
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") options.headless = true;
+        else if (arg == "--width" && hasValue) options.width = std::atoi(argv[++i]);
+        else if (arg == "--height" && hasValue) options.height = std::atoi(argv[++i]);
+        else if (arg == "--frames" && hasValue) options.frames = (unsigned int)std::atoi(argv[++i]);
+        else if (arg == "--output" && hasValue) options.output = argv[++i];
+        else if (arg == "--benchmark" && hasValue) options.benchmark = argv[++i];
+        else if (arg == "--path" && hasValue) options.cameraPath = argv[++i];
+        else if (arg == "--seed" && hasValue) options.seed = (unsigned int)std::atoi(argv[++i]);
+        else if (arg == "--golden" && hasValue) options.golden = argv[++i];
+        else if (arg == "--update-golden") options.updateGolden = true;
+        else if (arg == "--trace" && hasValue) options.trace = argv[++i];
+        else if (arg == "--stats" && hasValue) options.stats = argv[++i];
+        else if (arg == "--stats-every" && hasValue) options.statsEvery = (unsigned int)std::atoi(argv[++i]);
+        else if (arg == "--heightmap" && hasValue) options.heightmap = argv[++i];
+        else if (arg == "--bake-world") options.bakeWorld = true;
+        else if (arg == "--pack" && hasValue) options.pack = argv[++i];
+        else if (arg == "--no-texture-compression") options.compressTextures = false;
+        else if (arg == "--renderer" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "forward") options.renderPath = RENDER_FORWARD;
+            else if (name == "deferred") options.renderPath = RENDER_DEFERRED;
+            else std::cout << "ATTENZIONE: --renderer " << name << " sconosciuto (forward|deferred), uso forward" << std::endl;
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    // Thread di lavoro per caricamento, culling e luci (il main è il thread 0)
+    jobs.Start();
+
+    // --- MICROBENCHMARK (senza finestra) ---
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--bench-lights") == 0) { BenchmarkClusteredLighting(); return 0; }
+        if (std::strcmp(argv[i], "--bench-jobs") == 0) { BenchmarkJobSystem(PROJECT_ROOT "/assets"); return 0; }
+        if (std::strcmp(argv[i], "--bench-transforms") == 0) { BenchmarkTransforms(); return 0; }
+        if (std::strcmp(argv[i], "--bench-scatter") == 0) { BenchmarkScatter(); return 0; }
+        if (std::strcmp(argv[i], "--bench-io") == 0) { BenchmarkAsyncIO(PROJECT_ROOT "/assets"); return 0; }
+    }
+    Options options = parseOptions(argc, argv);
+    // Percorso iniziale: vale anche per headless, golden e benchmark (finisce nel JSON)
+    renderPath = options.renderPath;
+
+    // Traccia CPU dall'avvio (caricamento compreso), scritta da finishTrace() su ogni uscita
+    if (!options.trace.empty()) {
+#ifdef CPU_TRACE
+        traceOutput = options.trace;
+        CPU_TRACE_START();
+        CPU_TRACE_THREAD("main");
+#else
+        std::cout << "ATTENZIONE: --trace ignorato, compilato senza CPU_TRACE" << std::endl;
+#endif
+    }
+
+    // Harness golden: risoluzione e pose vengono dal file di budget della scena
+    SceneBudget budget;
+    if (!options.golden.empty()) {
+        if (!budget.Load(options.golden)) return -1;
+        options.headless = true;
+        options.width = budget.width;
+        options.height = budget.height;
+    }
+
+    // --- CONTESTO: finestra a schermo intero, oppure offscreen su Mesa ---
+    GLFWwindow* window = NULL;
+    HeadlessContext headless;
+    RenderTarget offscreen;
+    int width = options.width, height = options.height;
+    if (options.headless) {
+        if (!headless.Create(width, height)) return -1;
+        if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::GetProcAddress)) return -1;
+        glExt.Load((GLADloadproc)HeadlessContext::GetProcAddress);
+        if (!offscreen.Create(width, height)) return -1;
+        std::cout << "HEADLESS: " << headless.backend << ", " << glGetString(GL_RENDERER) << ", "
+                  << width << "x" << height << std::endl;
+    } else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
+        width = mode->width;
+        height = mode->height;
+        window = glfwCreateWindow(width, height, "Foresta 3D Finale", primaryMonitor, NULL);
+        if (window == NULL) { glfwTerminate(); return -1; }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return -1;
+        glExt.Load((GLADloadproc)glfwGetProcAddress);
+    }
     glEnable(GL_DEPTH_TEST);
+    framebufferWidth = width;
+    framebufferHeight = height;
+    camera.MovementSpeed = 25.0f;
+
+    // --- SHADER (da file, varianti compilate in parallelo e cache dei binari su disco) ---
+    ShaderCache shaderCache("shader_cache");
+    ShaderLibrary shaders(std::string(PROJECT_ROOT) + "/shaders", shaderCache);
+    shaders.BindUniformBlock("Lighting", LIGHTING_UBO_BINDING);
+    shaders.BindSampler("lightData", LIGHT_DATA_UNIT);
+    shaders.BindSampler("clusterData", CLUSTER_DATA_UNIT);
+    shaders.BindSampler("lightIndices", LIGHT_INDEX_UNIT);
+    shaders.BindUniformBlock("Shadows", SHADOW_UBO_BINDING);
+    shaders.BindSampler("shadowMap", SHADOW_MAP_UNIT);
+    shaders.Register("forest", "forest.vert", "forest.frag");
+    shaders.Register("shadow", "shadow.vert", "shadow.frag");
+    shaders.BindSampler("gAlbedo", GBUFFER_ALBEDO_UNIT);
+    shaders.BindSampler("gNormal", GBUFFER_NORMAL_UNIT);
+    shaders.BindSampler("gDepth", GBUFFER_DEPTH_UNIT);
+    shaders.Register("gbuffer", "forest.vert", "gbuffer.frag");
+    shaders.Register("deferred", "fullscreen.vert", "deferred_light.frag");
+    shaders.BindSampler("heightmap", TERRAIN_HEIGHT_UNIT);
+    shaders.Register("terrain", "terrain.vert", "forest.frag");
+    shaders.Register("terrain_gbuffer", "terrain.vert", "gbuffer.frag");
+    shaders.Register("grass", "grass.vert", "forest.frag");
+    shaders.Register("grass_gbuffer", "grass.vert", "gbuffer.frag");
+    // Tutte le varianti partono subito: il driver compila mentre carichiamo i modelli
+    shaders.RequestAll("forest", SHADER_ALPHA_TEST | SHADER_NORMAL_MAP | SHADER_INSTANCED | SHADER_SHADOW_RECEIVER);
+    shaders.RequestAll("shadow", SHADER_ALPHA_TEST | SHADER_INSTANCED);
+    shaders.RequestAll("gbuffer", SHADER_ALPHA_TEST | SHADER_NORMAL_MAP | SHADER_INSTANCED);
+    shaders.RequestAll("deferred", SHADER_SHADOW_RECEIVER);
+    shaders.RequestAll("terrain", SHADER_SHADOW_RECEIVER);
+    shaders.RequestAll("terrain_gbuffer", 0);
+    shaders.RequestAll("grass", SHADER_SHADOW_RECEIVER);
+    shaders.RequestAll("grass_gbuffer", 0);
+    std::cout << "SHADER CACHE: " << shaderCache.hits << " hit, " << shaderCache.misses << " miss, "
+              << shaderCache.rejected << " rifiutati" << std::endl;
 
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    CameraBuffer cameraBuffer;
+    cameraBuffer.Create();
+
+    // --- LUCI ---
+    std::vector<PointLight> sceneLights = createSceneLights(200, options.seed);
+    std::vector<PointLight> frameLights = sceneLights;
+    ClusteredLighting clusters;
+    clusters.Create();
+    const glm::vec3 sunDirection(-0.3f, -1.0f, -0.4f);
+
+    ShadowMaps shadows;
+    shadows.Create();
+
+    DeferredRenderer deferred;
+    deferred.Create(width, height);
+
+    // Tempi GPU/CPU per pass e per modello, in coda a gpu_profile.log
+    GpuProfiler profiler;
+    profiler.Create();
+
+    // Contatori del frame (draw, triangoli, bind, upload...) su file ogni N frame
+    RenderStatsLog statsLog;
+    if (!options.stats.empty())
+        statsLog.Open(options.stats, options.statsEvery);
 
     // --- CARICAMENTO MODELLO ---
-    // Assicurati che questo percorso sia corretto e che Model.h sia aggiornato
-    Model floorModel("C:\\Users\\andre\\Documents\\GitHub\\Computer_Graphics\\assets\\terrain\\floor.obj");
-    // --- DISEGNO IL PAVIMENTO ---
-    glm::mat4 modelFloor = glm::mat4(1.0f);
-    // Lo mettiamo a Y = -2.0 (o dove poggiano i tuoi alberi)
-    modelFloor = glm::translate(modelFloor, glm::vec3(0.0f, -2.0f, 0.0f)); 
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &modelFloor[0][0]);
-    floorModel.Draw(shaderProgram);
-
-    Model rockModel("C:\\Users\\andre\\Documents\\GitHub\\Computer_Graphics\\assets\\granite_stone\\granite_stone.obj"); 
-    Model treeModel("C:\\Users\\andre\\Documents\\GitHub\\Computer_Graphics\\assets\\realistic_trees\\realistic_trees.obj"); 
-
-    
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+    // Percorsi relativi alla radice del progetto, validi anche sulle macchine di render
+    const std::string assets = std::string(PROJECT_ROOT) + "/assets/";
+    // Con l'archivio montato modelli e texture si leggono dalla sua mappa in memoria
+    std::string packPath = options.pack.empty() ? std::string(PROJECT_ROOT) + "/assets.pack" : options.pack;
+    if (vfs.Mount(packPath, assets))
+        std::cout << "VFS: " << packPath << " montato, " << vfs.Pack().EntryCount() << " file" << std::endl;
+    else if (!options.pack.empty())
+        std::cout << "ERRORE::VFS:: impossibile aprire " << options.pack << std::endl;
+    // Texture compresse a blocchi: la prima volta si codificano, poi si leggono dalla cache
+    textureCache.enabled = options.compressTextures;
+    textureCache.Create("texture_cache");
+    Model rockModel(assets + "granite_stone/granite_stone.obj");
+    Model treeModel(assets + "realistic_trees/realistic_trees.obj");
+
+    // --- TERRENO ---
+    // Quadtree CDLOD sulla heightmap; piano a Y = -2.0 vicino all'origine (dove poggiano gli alberi)
+    Terrain terrain;
+    terrain.Create(options.heightmap, assets + "terrain", options.seed);
+    if (vfs.Mounted())
+        std::cout << "VFS: " << vfs.stats.packHits << "/" << vfs.stats.lookups << " file dall'archivio ("
+                  << vfs.stats.mappedBytes / 1024 << " KB senza copie, " << vfs.stats.decompressedBytes / 1024
+                  << " KB decompressi), " << vfs.stats.diskReads << " letti da disco" << std::endl;
+    textureCache.Report();
+
+    // --- FORESTA ---
+    // Alberi e rocce sparsi sul terreno (Poisson disc, seed della scena), disegnati istanziati.
+    // Il mondo è diviso in celle caricate attorno alla camera (vedi WorldStreaming.h).
+    std::vector<ScatterLayer> layers(2);
+    layers[0].model = &treeModel;
+    layers[0].name = "alberi";
+    layers[0].minDistance = 14.0f;
+    layers[0].maxSlope = 30.0f;
+    layers[0].minScale = 0.8f;
+    layers[0].maxScale = 1.3f;
+    layers[0].sink = 0.3f;
+    // Radura attorno alla scena di partenza, poi macchie più o meno fitte
+    layers[0].density = [](float x, float z) {
+        float clearing = glm::smoothstep(25.0f, 45.0f, std::sqrt(x * x + z * z));
+        return clearing * glm::clamp(0.5f + 0.7f * std::sin(x * 0.013f) * std::sin(z * 0.011f), 0.1f, 1.0f);
+    };
+    layers[1].model = &rockModel;
+    layers[1].name = "rocce";
+    layers[1].minDistance = 20.0f;
+    layers[1].maxSlope = 45.0f;
+    layers[1].minScale = 0.5f;
+    layers[1].maxScale = 1.5f;
+    layers[1].alignToNormal = 1.0f;
+    layers[1].sink = 0.2f;
+    layers[1].density = [](float x, float z) { return glm::smoothstep(15.0f, 30.0f, std::sqrt(x * x + z * z)); };
+    Scatter forest;
+    WorldStreamer world("world_cache/" + std::to_string(options.seed));
+    world.Create(terrain, forest, layers, options.seed, options.heightmap);
+    if (options.bakeWorld) {
+        auto bakeStart = std::chrono::high_resolution_clock::now();
+        world.Bake();
+        std::cout << "MONDO: " << world.CellsPerSide() * world.CellsPerSide() << " celle su disco in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count()
+                  << " ms" << std::endl;
+    }
+    WorldCellBuffers worldCells;
+    // Storia della camera: le celle dove sta andando si caricano in anticipo
+    CameraPredictor cameraMotion;
 
-        processInput(window);
+    // --- ERBA ---
+    // Ciuffi istanziati sulle tile di terreno vicine alla camera, generati al volo
+    GrassField grass;
+    grass.Create(terrain, options.seed);
+
+    // --- SCENA ---
+    // Entità con componenti SoA; i sistemi (bounds, LOD) girano sul job system
+    EntityRegistry scene;
+    scene.Create({ &treeModel, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -2.0f, -5.0f)), true, "albero" });
+    scene.Create({ &rockModel, glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -2.0f, -2.0f)), true, "roccia" });
+    // Culling e ordinamento sui thread di lavoro, invio sul thread GL
+    DrawList drawList;
+    unsigned int frameCount = 0;
+
+    // --- FRAME ---
+    // Lo stesso percorso per finestra e headless: disegna nel framebuffer attivo
+    // lo stato copiato in 'frame', senza leggere camera e scena del thread principale
+    RenderPath framePath = renderPath; // percorso dell'ultimo frame disegnato
+    auto drawFrame = [&](FrameSnapshot const &frame) {
+        CPU_ZONE("frame");
+        Camera camera = frame.camera;
+        framePath = (RenderPath)frame.renderPath;
+        if (frame.width != width || frame.height != height) {
+            width = frame.width;
+            height = frame.height;
+            glViewport(0, 0, width, height);
+            deferred.Resize(width, height);
+        }
+        profiler.BeginFrame();
+        renderStats.Reset();
 
         // Sfondo Cielo
         glClearColor(0.5f, 0.7f, 0.9f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glUseProgram(shaderProgram);
-        glUniform3fv(glGetUniformLocation(shaderProgram, "viewPos"), 1, &camera.Position[0]);
-
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)mode->width / (float)mode->height, 0.1f, 200.0f);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+        // Raccoglie le varianti di shader finite nel frattempo (non blocca)
+        shaders.Update();
 
+        float aspect = (float)width / (float)height;
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 200.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
-        camera.MovementSpeed = 25.0f; 
-
-        // --- 1. DISEGNA PAVIMENTO ---
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -2.0f, 0.0f)); 
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-        floorModel.Draw(shaderProgram); // <--- Usa floorModel
-
-        // --- 2. DISEGNA ALBERO ---
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -2.0f, -5.0f)); 
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f)); 
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-        treeModel.Draw(shaderProgram); // <--- CAMBIA QUI: da ourModel a treeModel
-
-        // --- 3. DISEGNA SASSO ---
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(3.0f, -2.0f, -2.0f)); 
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));       
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-        rockModel.Draw(shaderProgram); // <--- Usa rockModel
-
-        glfwSwapBuffers(window);
+
+        // --- CLUSTER DI LUCI ---
+        // Le lucciole oscillano in verticale, quindi le liste si ricostruiscono ogni frame
+        jobs.ParallelFor(sceneLights.size() - 3, 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin + 3; i < end + 3; i++)
+                frameLights[i].Position.y = sceneLights[i].Position.y + 0.5f * std::sin(frame.time * 1.3f + (float)i);
+        });
+        // Forward: froxel 16x9x24. Deferred: tile da 16 pixel su tutta la profondità.
+        profiler.Begin("luci");
+        ClusteredLighting &lightGrid = framePath == RENDER_FORWARD ? clusters : deferred.tiles;
+        lightGrid.SetProjection(glm::radians(camera.Zoom), aspect, 0.1f, 200.0f);
+        lightGrid.Build(frameLights, view);
+        lightGrid.Upload(sunDirection, glm::vec3(0.9f, 0.85f, 0.7f), glm::vec3(0.25f, 0.3f, 0.35f),
+                         (float)width / lightGrid.tilesX, (float)height / lightGrid.tilesY);
+        lightGrid.Bind();
+        profiler.End();
+
+        // --- OMBRE DEL SOLE (prima del pass principale: usano il blocco Camera) ---
+        profiler.Begin("ombre");
+        shadows.Render(frame.scene, shaders, cameraBuffer, view, glm::radians(camera.Zoom), aspect, 0.1f, sunDirection);
+        shadows.Bind();
+        profiler.End();
+        cameraBuffer.Update(view, projection, camera.Position);
+
+        // --- SCENA ---
+        terrain.Select(projection * view, camera.Position);
+        grass.Update(camera.Position);
+        worldCells.Sync(frame.cells);
+        if (framePath == RENDER_FORWARD) {
+            drawList.Build(frame.scene, projection * view, camera.Position);
+            CPU_ZONE("submit forward");
+            {
+                GpuScope pass(profiler, "opachi");
+                drawList.Submit(frame.scene, shaders, "forest", SHADER_SHADOW_RECEIVER);
+            }
+            {
+                GpuScope pass(profiler, "foresta");
+                worldCells.Render(forest, shaders, "forest", projection * view, camera.Position, SHADER_SHADOW_RECEIVER);
+            }
+            {
+                GpuScope pass(profiler, "terreno");
+                terrain.Render(shaders, "terrain", SHADER_SHADOW_RECEIVER);
+            }
+            GpuScope pass(profiler, "erba");
+            grass.Render(shaders, "grass", projection * view, camera.Position, frame.time, SHADER_SHADOW_RECEIVER);
+        } else {
+            {
+                drawList.Build(frame.scene, projection * view, camera.Position, ~SHADER_SHADOW_RECEIVER);
+                CPU_ZONE("submit gbuffer");
+                GpuScope pass(profiler, "gbuffer");
+                deferred.BeginGeometry();
+                drawList.Submit(frame.scene, shaders, "gbuffer");
+                worldCells.Render(forest, shaders, "gbuffer", projection * view, camera.Position, 0, ~SHADER_SHADOW_RECEIVER);
+                terrain.Render(shaders, "terrain_gbuffer");
+                grass.Render(shaders, "grass_gbuffer", projection * view, camera.Position, frame.time);
+            }
+            GpuScope pass(profiler, "illuminazione");
+            deferred.LightingPass(shaders, view, projection, SHADER_SHADOW_RECEIVER);
+        }
+        profiler.EndFrame();
+
+        if (++frameCount % 300 == 0) {
+            ShadowStats const &s = shadows.stats;
+            std::cout << "OMBRE: " << s.drawCalls << " draw, " << s.culled << "/" << s.casters << " scartati, "
+                      << s.cascadesRendered << " cascate ridisegnate, " << s.cascadesCached << " in cache, "
+                      << s.cpuMs << " ms CPU, " << s.gpuMs << " ms GPU" << std::endl;
+            std::cout << "MONDO: " << worldCells.CellCount() << " celle in VRAM, " << worldCells.cellsDrawn
+                      << " disegnate" << std::endl;
+            std::cout << "ERBA: " << grass.tilesDrawn << " tile, " << grass.Blades() << " fili, densità x"
+                      << grass.densityScale << std::endl;
+            std::cout << "FRAME: forward " << pathFrameMs[RENDER_FORWARD] << " ms, deferred "
+                      << pathFrameMs[RENDER_DEFERRED] << " ms (attivo: " << renderPathNames[framePath] << ")" << std::endl;
+            profiler.WriteLog("gpu_profile.log");
+            if (GpuProfiler::Timing const *frameTiming = profiler.Find("frame"))
+                std::cout << "PROFILER: " << frameTiming->gpuMs << " ms GPU, " << frameTiming->cpuMs << " ms CPU, "
+                          << (profiler.GpuBound() ? "limitato dalla GPU" : "limitato dalla CPU") << std::endl;
+        }
+
+    };
+    // Istantanea dello stato corrente del thread principale, sempre nella stessa
+    // memoria: tra un frame e l'altro si ricopiano solo le righe cambiate
+    FrameSnapshot snapshot;
+    auto takeSnapshot = [&](float time) -> FrameSnapshot const & {
+        FrameSnapshot &frame = snapshot;
+        frame.time = time;
+        frame.camera = camera;
+        frame.renderPath = renderPath;
+        frame.width = framebufferWidth;
+        frame.height = framebufferHeight;
+        scene.UpdateLod(camera.Position);
+        scene.CopyTo(frame.scene, frame.sceneVersion);
+        // Frame riproducibili: le celle attorno alla camera sono tutte caricate
+        cameraMotion.Record(time, camera);
+        world.Update(cameraMotion, true);
+        frame.cells = world.Resident();
+        return frame;
+    };
+    // Simulazione e rendering sullo stesso thread (frame scriptati, golden)
+    auto renderFrame = [&](float time) { drawFrame(takeSnapshot(time)); };
+    auto recordFrameTime = [&](std::chrono::high_resolution_clock::time_point start) {
+        double frameMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        pathFrameMs[framePath] = pathFrameMs[framePath] == 0.0 ? frameMs : pathFrameMs[framePath] * 0.95 + frameMs * 0.05;
+        // Il tempo GPU arriva con qualche frame di ritardo: si usa la media mobile
+        GpuProfiler::Timing const *gpu = profiler.Find("frame");
+        statsLog.Write(frameCount, frameMs, gpu ? gpu->gpuMs : 0.0, renderStats);
+    };
+
+    // --- REGRESSIONI: immagini golden + budget (codice di uscita != 0 se falliscono) ---
+    if (!options.golden.empty()) {
+        shaders.WaitAll();
+        std::filesystem::create_directories("golden_out");
+        std::string goldenDirectory = std::filesystem::path(options.golden).parent_path().string();
+        int status = RunGoldenHarness(budget, goldenDirectory.empty() ? "." : goldenDirectory, "golden_out",
+                                      options.updateGolden, camera, offscreen, profiler, renderFrame);
+        headless.Destroy();
+        finishTrace();
+        return status;
+    }
+
+    // --- FRAME SCRIPTATI (headless e/o benchmark) ---
+    // Tempo a passo fisso (60 Hz), shader tutti pronti e, nel benchmark, camera
+    // guidata dal percorso invece che da tastiera e mouse: frame riproducibili
+    if (options.headless || !options.benchmark.empty()) {
+        bool benchmark = !options.benchmark.empty();
+        CameraPath path = CameraPath::Default();
+        if (!options.cameraPath.empty() && !path.Load(options.cameraPath)) { finishTrace(); return -1; }
+
+        FlythroughResult result;
+        result.renderer = renderPathNames[renderPath];
+        result.backend = options.headless ? headless.backend : "GLFW";
+        result.gpu = (const char *)glGetString(GL_RENDERER);
+        result.width = width;
+        result.height = height;
+        result.seed = options.seed;
+        profiler.recordHistory = benchmark;
+
+        shaders.WaitAll();
+        for (unsigned int i = 0; i < options.frames; i++) {
+            if (benchmark)
+                path.Apply(camera, options.frames > 1 ? (float)i / (float)(options.frames - 1) : 0.0f);
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            if (options.headless)
+                offscreen.Bind();
+            renderFrame((float)i / 60.0f);
+            if (options.headless)
+                glFlush();
+            else
+                glfwSwapBuffers(window);
+            recordFrameTime(frameStart);
+            result.cpuMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+            result.drawCalls.push_back((double)renderStats.drawCalls);
+            result.triangles.push_back((double)renderStats.triangles);
+            if (window) glfwPollEvents();
+        }
+        glFinish();
+        profiler.Flush();
+        result.gpuMs = profiler.frameHistory;
+
+        std::cout << "SCRIPT: " << options.frames << " frame, " << pathFrameMs[renderPath] << " ms/frame ("
+                  << renderPathNames[renderPath] << ", " << result.backend << ")" << std::endl;
+        if (benchmark && WriteFlythroughJson(options.benchmark, result))
+            std::cout << "BENCHMARK: risultati in " << options.benchmark << std::endl;
+        if (options.headless && !options.output.empty() && offscreen.SavePPM(options.output))
+            std::cout << "HEADLESS: immagine salvata in " << options.output << std::endl;
+        if (options.headless) headless.Destroy();
+        else glfwTerminate();
+        finishTrace();
+        return 0;
+    }
+
+    // --- THREAD DI RENDERING ---
+    // Il contesto GL passa al render thread, che disegna le istantanee prodotte
+    // qui. Il thread principale resta su input e simulazione: un frame lento non
+    // ritarda più la lettura di tastiera e mouse. Una istantanea in coda più una
+    // in disegno: al massimo 2 frame di latenza tra input e immagine.
+    // Le istantanee disegnate tornano indietro su 'recycled': la successiva si
+    // aggiorna nella loro memoria invece di ricopiare tutta la scena.
+    SpscQueue<FrameSnapshot, 1> snapshots;
+    SpscQueue<FrameSnapshot, 2> recycled;
+    std::atomic<bool> quit{ false };
+    glfwMakeContextCurrent(NULL);
+    std::thread renderThread([&]() {
+        CPU_TRACE_THREAD("render");
+        glfwMakeContextCurrent(window);
+        FrameSnapshot frame;
+        while (true) {
+            if (!snapshots.Pop(frame)) {
+                if (quit.load())
+                    break;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            drawFrame(frame);
+            glfwSwapBuffers(window);
+            recordFrameTime(frameStart);
+            recycled.Push(std::move(frame));
+        }
+        glfwMakeContextCurrent(NULL);
+    });
+
+    // Simulazione a 60 Hz; il render thread riceve lo stato interpolato tra gli
+    // ultimi due passi, quindi il movimento resta fluido a qualsiasi frame rate
+    FixedTimestep timestep(1.0f / 60.0f, 5);
+    deltaTime = timestep.step;
+    Camera previousCamera = camera;
+    SceneComponents previousScene;
+    uint64_t previousVersion = 0;
+    scene.CopyTo(previousScene, previousVersion);
+    unsigned int simulationFrames = 0;
+    lastFrame = static_cast<float>(glfwGetTime());
+    while (!glfwWindowShouldClose(window)) {
+        float currentFrame = static_cast<float>(glfwGetTime());
+        unsigned int steps = timestep.Advance(currentFrame - lastFrame);
+        lastFrame = currentFrame;
+
         glfwPollEvents();
+        for (unsigned int i = 0; i < steps; i++) {
+            previousCamera = camera;
+            scene.CopyTo(previousScene, previousVersion);
+            processInput(window);
+        }
+        // Coda piena: il render thread è indietro, si continua a leggere l'input
+        // e l'istantanea si prende appena c'è posto (quindi è la più recente)
+        if (snapshots.Full()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        FrameSnapshot frame;
+        recycled.Pop(frame);
+        frame.time = timestep.InterpolatedTime();
+        frame.camera = InterpolateCamera(previousCamera, camera, timestep.Alpha());
+        frame.renderPath = renderPath;
+        frame.width = framebufferWidth;
+        frame.height = framebufferHeight;
+        scene.UpdateLod(frame.camera.Position);
+        InterpolateScene(previousScene, scene, timestep.Alpha(), frame.scene, frame.sceneVersion);
+        cameraMotion.Record(frame.time, frame.camera);
+        world.Update(cameraMotion);
+        frame.cells = world.Resident();
+        snapshots.Push(std::move(frame));
+        if (++simulationFrames % 300 == 0) {
+            WorldStreamingStats const &w = world.stats;
+            std::cout << "MONDO: " << w.resident << " celle residenti (" << w.residentBytes / 1024 << " KB), "
+                      << w.loading << " in caricamento, " << w.loads << " caricate (" << w.diskHits << " da disco, "
+                      << w.generated << " generate), " << w.unloads << " scaricate, " << w.budgetEvictions
+                      << " per il budget, " << w.budgetDeferred << " rimandate" << std::endl;
+            std::cout << "PREFETCH: " << w.HitRate() * 100.0 << "% hit (" << w.hits << " hit, " << w.misses
+                      << " miss), " << w.prefetched << " celle anticipate, " << w.prefetchHits << " servite, "
+                      << w.prefetchWasted << " sprecate" << std::endl;
+        }
     }
+    if (timestep.droppedSteps)
+        std::cout << "SIMULAZIONE: " << timestep.droppedSteps << " passi scartati dopo blocchi lunghi" << std::endl;
+    quit.store(true);
+    renderThread.join();
+    finishTrace();
 
     glfwTerminate();
     return 0;
@@ -167,6 +659,17 @@ void processInput(GLFWwindow *window) {
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.ProcessKeyboard(RIGHT, deltaTime);
 }
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+        renderPath = renderPath == RENDER_FORWARD ? RENDER_DEFERRED : RENDER_FORWARD;
+        std::cout << "RENDERER: " << renderPathNames[renderPath] << std::endl;
+    }
+    // Registra la posa corrente come punto chiave del percorso del benchmark
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        CameraPath::Append("camera_path.txt", camera);
+        std::cout << "PERCORSO: punto aggiunto a camera_path.txt" << std::endl;
+    }
+}
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     float xpos = static_cast<float>(xposIn);
     float ypos = static_cast<float>(yposIn);
@@ -175,4 +678,5 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     lastX = xpos; lastY = ypos;
 }
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) { camera.ProcessMouseScroll(static_cast<float>(yoffset)); }
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) { glViewport(0, 0, width, height); }
\ No newline at end of file
+// Il viewport lo aggiorna il render thread quando riceve la nuova dimensione
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) { framebufferWidth = width; framebufferHeight = height; }
\ No newline at end of file
@@ -0,0 +1,80 @@
+// --- COSTRUZIONE DELL'ARCHIVIO DEGLI ASSET ---
+// Uso: pack_builder <cartella asset> <archivio.pack> [--lz4 | --zstd] [--level N]
+// Tutti i file sotto la cartella entrano nell'archivio con il percorso relativo
+// come chiave (es. realistic_trees/leaves_baseColor.png), lo stesso che il VFS
+// ricava dai percorsi sotto PROJECT_ROOT/assets. Alla fine l'archivio viene
+// riaperto e ogni entry confrontata con il file originale.
+#include "PackFile.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool SameAsFile(PackFile const &pack, PackEntry const &entry, std::string const &path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file || (uint64_t)file.tellg() != entry.size)
+        return false;
+    std::vector<unsigned char> original((size_t)entry.size), packed;
+    file.seekg(0);
+    file.read((char *)original.data(), original.size());
+    if (!pack.Read(entry, packed))
+        return false;
+    return packed == original;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Uso: pack_builder <cartella asset> <archivio.pack> [--lz4 | --zstd] [--level N]" << std::endl;
+        return 1;
+    }
+    jobs.Start();
+    std::filesystem::path source = argv[1];
+    std::string output = argv[2];
+    PackWriter writer;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--lz4") == 0) writer.compression = PACK_LZ4;
+        else if (std::strcmp(argv[i], "--zstd") == 0) writer.compression = PACK_ZSTD;
+        else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) writer.level = std::atoi(argv[++i]);
+    }
+
+    std::vector<std::pair<std::string, std::string>> files;
+    std::error_code error;
+    for (auto const &item : std::filesystem::recursive_directory_iterator(source, error)) {
+        if (!item.is_regular_file())
+            continue;
+        std::string name = std::filesystem::relative(item.path(), source).generic_string();
+        files.push_back({ name, item.path().string() });
+        writer.Add(name, item.path().string());
+    }
+    if (error || files.empty()) {
+        std::cout << "ERRORE::PACK::CARTELLA " << source.string() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!writer.Write(output))
+        return 1;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "PACK: " << files.size() << " file, " << writer.originalBytes / 1024 << " KB -> " << writer.storedBytes / 1024
+              << " KB (" << writer.compressedEntries << " compressi con " << PackCompressionName(writer.compression)
+              << ") in " << ms << " ms" << std::endl;
+
+    PackFile pack;
+    if (!pack.Open(output))
+        return 1;
+    unsigned int wrong = 0;
+    for (auto const &file : files) {
+        PackEntry const *entry = pack.Find(file.first);
+        if (!entry || !SameAsFile(pack, *entry, file.second)) {
+            std::cout << "ERRORE::PACK::VERIFICA " << file.first << std::endl;
+            wrong++;
+        }
+    }
+    std::cout << "PACK: verifica " << (wrong ? "fallita" : "riuscita") << " su " << pack.EntryCount() << " entry" << std::endl;
+    return wrong ? 1 : 0;
+}